@@ -0,0 +1,1525 @@
+// Benchmarks of the search engine in pacman.cpp.
+// Run without arguments to execute every benchmark, or pass the names of the ones to run.
+// Build with CMAKE_BUILD_TYPE=Release, numbers of unoptimized builds mean nothing.
+#define PACMAN_NO_MAIN
+#include "pacman.cpp"
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <cstring>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <new>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+namespace pacman_benchmark {
+// every heap allocation of the program, for pacman_allocations
+std::atomic<std::size_t> allocation_count{0};
+// checks that failed, main returns 1 if there are any
+int failed_checks = 0;
+
+// Counts a failed check and returns the stream for its message
+std::ostream& failed_check () {
+    ++failed_checks;
+    return std::cout << "FAILED: ";
+}
+} // namespace pacman_benchmark
+
+// out of line, or gcc matches the inlined malloc() and free() against new and delete
+__attribute__((noinline)) void* operator new ( std::size_t size ) {
+    ++pacman_benchmark::allocation_count;
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+__attribute__((noinline)) void operator delete ( void* p ) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete ( void* p, std::size_t ) noexcept { std::free(p); }
+
+namespace pacman_benchmark {
+
+struct Stopwatch {
+    std::chrono::time_point<std::chrono::steady_clock> start_{std::chrono::steady_clock::now()};
+
+    double elapsed_ms () const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+    }
+};
+
+// Runs f `repeat` times and returns the best time in milliseconds
+template <typename F>
+double best_of ( int repeat, F&& f ) {
+    double best = std::numeric_limits<double>::max();
+    for (int i = 0; i < repeat; ++i) {
+        Stopwatch sw;
+        f();
+        best = std::min(best, sw.elapsed_ms());
+    }
+    return best;
+}
+
+using a_star_search::CountingIterator;
+
+//-------------------------------------------------------------------------
+
+struct PacmanMap {
+    std::string name_;
+    int r_, c_;
+    std::vector<std::string> grid_;
+    pacman_task::pacman_state_t start_, goal_;
+};
+
+PacmanMap read_map ( std::string const& file_name ) {
+    PacmanMap map;
+    map.name_ = file_name;
+
+    std::ifstream in(std::string(PACMAN_INPUT_DIR) + "/" + file_name);
+    in >> map.start_.first >> map.start_.second >> map.goal_.first >> map.goal_.second >> map.r_ >> map.c_;
+    map.grid_.resize(map.r_);
+    for (auto& row : map.grid_)
+        in >> row;
+    return map;
+}
+
+// Perfect maze of corridors (recursive backtracker) with some extra walls knocked out to make loops,
+// goes from the top left to the bottom right corner
+PacmanMap maze_map ( int r, int c, std::mt19937& rng ) {
+    PacmanMap map{"maze " + std::to_string(r) + "x" + std::to_string(c), r, c,
+                  std::vector<std::string>(r, std::string(c, '%')), {1, 1}, {(r - 2) | 1, (c - 2) | 1}};
+    if (map.goal_.first >= r - 1) map.goal_.first -= 2;
+    if (map.goal_.second >= c - 1) map.goal_.second -= 2;
+
+    std::vector<pacman_task::pacman_state_t> stack{map.start_};
+    map.grid_[1][1] = '-';
+    while (!stack.empty()) {
+        auto cell = stack.back();
+        pacman_task::pacman_state_t next[4];
+        int n = 0;
+        for (auto const& sh : {std::make_pair(-2, 0), std::make_pair(0, -2), std::make_pair(0, 2), std::make_pair(2, 0)}) {
+            int i = cell.first + sh.first, j = cell.second + sh.second;
+            if (i > 0 && j > 0 && i < r - 1 && j < c - 1 && map.grid_[i][j] == '%')
+                next[n++] = {i, j};
+        }
+        if (n == 0) {
+            stack.pop_back();
+            continue;
+        }
+        auto to = next[rng() % n];
+        map.grid_[(cell.first + to.first) / 2][(cell.second + to.second) / 2] = '-';
+        map.grid_[to.first][to.second] = '-';
+        stack.push_back(to);
+    }
+
+    for (int i = 1; i < r - 1; ++i)
+        for (int j = 1; j < c - 1; ++j)
+            if (map.grid_[i][j] == '%' && (i % 2 == 1 || j % 2 == 1) && rng() % 10 == 0)
+                map.grid_[i][j] = '-';
+    return map;
+}
+
+// Walled room with sparse single wall cells, goes from the top left to the bottom right corner
+PacmanMap open_room_map ( int r, int c, std::mt19937& rng, int wall_percent = 10 ) {
+    PacmanMap map{"open room " + std::to_string(r) + "x" + std::to_string(c), r, c,
+                  std::vector<std::string>(r, std::string(c, '-')), {1, 1}, {r - 2, c - 2}};
+    for (int i = 0; i < r; ++i)
+        for (int j = 0; j < c; ++j)
+            if (i == 0 || j == 0 || i == r - 1 || j == c - 1 || int(rng() % 100) < wall_percent)
+                map.grid_[i][j] = '%';
+    map.grid_[1][1] = map.grid_[r - 2][c - 2] = '-';
+    return map;
+}
+
+// Small grid for the cross-checks, every cell is a wall with the given chance
+std::vector<std::string> random_grid ( int r, int c, int wall_percent, std::mt19937& rng ) {
+    std::vector<std::string> grid(r, std::string(c, '-'));
+    for (auto& row : grid)
+        for (auto& cell : row)
+            if (int(rng() % 100) < wall_percent)
+                cell = '%';
+    return grid;
+}
+
+//-------------------------------------------------------------------------
+
+template <typename TQueue>
+double pacman_search_ms ( PacmanMap const& map, int repeat, size_t& expanded, size_t& path_length ) {
+    return best_of(repeat, [&]() {
+        std::vector<pacman_task::pacman_state_t> result_path, explored_nodes;
+        pacman_task::pacman_solve<TQueue>(map.r_, map.c_, map.grid_, map.start_, map.goal_, result_path, explored_nodes);
+        expanded = explored_nodes.size();
+        path_length = result_path.size() - 1;
+    });
+}
+
+void pacman_frontiers () {
+    using pacman_task::pacman_node_t;
+
+    struct MinScore {
+        bool operator() ( pacman_node_t const l, pacman_node_t const r ) const { return l->get_total_score() > r->get_total_score(); }
+    };
+    using heap_t = std::priority_queue<pacman_node_t, std::vector<pacman_node_t>, MinScore>;
+    using buckets_t = a_star_search::BucketQueue<pacman_node_t>;
+
+    std::cout << "UCS frontier, ms per search" << std::endl;
+    std::cout << std::setw(24) << "map" << std::setw(10) << "expanded" << std::setw(8) << "path"
+              << std::setw(14) << "binary heap" << std::setw(14) << "buckets" << std::setw(10) << "speedup" << std::endl;
+
+    std::mt19937 rng(42);
+    std::vector<PacmanMap> maps{read_map("ucs_test_input.txt"), maze_map(1001, 1001, rng), maze_map(2001, 2001, rng), open_room_map(2000, 2000, rng)};
+    for (auto const& map : maps) {
+        int repeat = map.r_ < 100 ? 1000 : 3;
+        size_t heap_expanded, heap_path, buckets_expanded, buckets_path;
+        double heap = pacman_search_ms<heap_t>(map, repeat, heap_expanded, heap_path);
+        double buckets = pacman_search_ms<buckets_t>(map, repeat, buckets_expanded, buckets_path);
+        if (heap_path != buckets_path)
+            failed_check() << "path length mismatch: " << heap_path << " vs " << buckets_path << std::endl;
+
+        std::cout << std::setw(24) << map.name_ << std::setw(10) << buckets_expanded << std::setw(8) << buckets_path
+                  << std::setw(14) << heap << std::setw(14) << buckets << std::setw(10) << heap / buckets << std::endl;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+template <typename FHeuristic>
+size_t pacman_astar_expansions ( PacmanMap const& map, FHeuristic const& heuristic, double& ms, size_t& path_length ) {
+    size_t expanded = 0;
+    ms = best_of(3, [&]() {
+        std::vector<pacman_task::pacman_state_t> result_path, explored_nodes;
+        pacman_task::pacman_solve<pacman_task::pacman_frontier_t>(map.r_, map.c_, map.grid_, map.start_, map.goal_,
+                                                                  result_path, explored_nodes, heuristic);
+        expanded = explored_nodes.size();
+        path_length = result_path.size() - 1;
+    });
+    return expanded;
+}
+
+// Manhattan A* on the indexed heap against BFS on small random grids: decrease_key has to
+// move queued cells onto shorter paths, so both find paths of the same length
+void check_decrease_key ( int grids ) {
+    using pacman_task::pacman_state_t;
+
+    std::mt19937 rng(5);
+    int mismatches = 0;
+    for (int g = 0; g < grids; ++g) {
+        std::vector<std::string> grid = random_grid(12, 12, int(rng() % 40), rng);
+        pacman_state_t start{int(rng() % 12), int(rng() % 12)}, goal{int(rng() % 12), int(rng() % 12)};
+
+        std::vector<pacman_state_t> bfs_path, bfs_explored, astar_path, astar_explored;
+        pacman_task::pacman_solve<std::queue<pacman_task::pacman_node_t>>(12, 12, grid, start, goal, bfs_path, bfs_explored);
+        pacman_task::pacman_solve<pacman_task::pacman_frontier_t>(12, 12, grid, start, goal, astar_path, astar_explored,
+                                                                  a_star_search::ManhattanHeuristic<pacman_state_t>{goal});
+        bool bfs_found = !bfs_path.empty() && bfs_path.front() == goal;
+        bool astar_found = !astar_path.empty() && astar_path.front() == goal;
+        mismatches += bfs_found != astar_found || (bfs_found && bfs_path.size() != astar_path.size());
+    }
+
+    std::cout << "Indexed heap A* against BFS on " << grids << " random 12x12 grids: " << mismatches << " mismatches" << std::endl;
+    if (mismatches != 0)
+        failed_check() << "A* with decrease_key misses shortest paths" << std::endl;
+}
+
+void pacman_heuristics () {
+    using pacman_task::pacman_state_t;
+
+    check_decrease_key(2000);
+
+    std::cout << "A* heuristics, expanded nodes (ms)" << std::endl;
+    std::cout << std::setw(24) << "map" << std::setw(8) << "path" << std::setw(22) << "none"
+              << std::setw(22) << "manhattan" << std::setw(12) << "fewer" << std::endl;
+
+    std::vector<PacmanMap> maps{read_map("ucs_test_input.txt")};
+    for (int wall_percent : {0, 10, 30}) {
+        std::mt19937 rng(wall_percent);
+        maps.push_back(open_room_map(1000, 1000, rng, wall_percent));
+        maps.back().name_ += " " + std::to_string(wall_percent) + "%";
+    }
+
+    for (auto const& map : maps) {
+        a_star_search::ManhattanHeuristic<pacman_state_t> manhattan{map.goal_};
+
+        double none_ms, manhattan_ms;
+        size_t none_path, manhattan_path;
+        size_t none = pacman_astar_expansions(map, a_star_search::DefaultHeuristic<pacman_state_t>{}, none_ms, none_path);
+        size_t manh = pacman_astar_expansions(map, manhattan, manhattan_ms, manhattan_path);
+        if (none_path != manhattan_path)
+            failed_check() << "path length mismatch: " << none_path << " " << manhattan_path << std::endl;
+
+        auto cell = [](size_t expanded, double ms) {
+            std::ostringstream out;
+            out << expanded << " (" << std::fixed << std::setprecision(2) << ms << ")";
+            return out.str();
+        };
+        std::cout << std::setw(24) << map.name_ << std::setw(8) << none_path << std::setw(22) << cell(none, none_ms)
+                  << std::setw(22) << cell(manh, manhattan_ms)
+                  << std::setw(11) << double(none) / manh << "x" << std::endl;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+std::vector<std::pair<pacman_task::pacman_state_t, pacman_task::pacman_state_t>>
+random_queries ( PacmanMap const& map, std::size_t count, std::mt19937& rng ) {
+    std::vector<std::pair<pacman_task::pacman_state_t, pacman_task::pacman_state_t>> queries;
+    auto free_cell = [&]() {
+        for (;;) {
+            pacman_task::pacman_state_t cell{int(rng() % map.r_), int(rng() % map.c_)};
+            if (map.grid_[cell.first][cell.second] != '%')
+                return cell;
+        }
+    };
+    while (queries.size() < count)
+        queries.emplace_back(free_cell(), free_cell());
+    return queries;
+}
+
+void pacman_landmarks () {
+    using pacman_task::pacman_state_t;
+
+    std::cout << "ALT landmarks, 16 landmarks, 100 random queries per map" << std::endl;
+    std::cout << std::setw(24) << "map" << std::setw(14) << "build 1 thr" << std::setw(14) << "build N thr"
+              << std::setw(14) << "manhattan" << std::setw(14) << "max(manh,alt)" << std::setw(10) << "fewer"
+              << std::setw(14) << "manh ms" << std::setw(14) << "alt ms" << std::endl;
+
+    std::mt19937 rng(7);
+    std::vector<PacmanMap> maps{maze_map(501, 501, rng), maze_map(1001, 1001, rng), open_room_map(1000, 1000, rng, 30)};
+    for (auto const& map : maps) {
+        pacman_task::PacmanStateFilter filter{map.r_, map.c_, map.grid_};
+
+        double build_single = best_of(1, [&]() { pacman_task::PacmanLandmarks(filter, 16, 1); });
+        Stopwatch build_sw;
+        pacman_task::PacmanLandmarks built(filter, 16);
+        double build_parallel = build_sw.elapsed_ms();
+
+        built.save("pacman_landmarks.bin");
+        auto landmarks = pacman_task::PacmanLandmarks::load("pacman_landmarks.bin");
+        std::remove("pacman_landmarks.bin");
+
+        size_t manhattan_expanded = 0, alt_expanded = 0;
+        double manhattan_ms = 0, alt_ms = 0;
+        for (auto const& q : random_queries(map, 100, rng)) {
+            PacmanMap query = map;
+            query.start_ = q.first;
+            query.goal_ = q.second;
+
+            double ms;
+            size_t manhattan_path, alt_path;
+            a_star_search::ManhattanHeuristic<pacman_state_t> manhattan{query.goal_};
+            manhattan_expanded += pacman_astar_expansions(query, manhattan, ms, manhattan_path);
+            manhattan_ms += ms;
+            alt_expanded += pacman_astar_expansions(query, a_star_search::max_of(manhattan, pacman_task::PacmanLandmarkHeuristic(landmarks, query.goal_)), ms, alt_path);
+            alt_ms += ms;
+            if (manhattan_path != alt_path)
+                failed_check() << "path length mismatch: " << manhattan_path << " vs " << alt_path << std::endl;
+        }
+
+        std::cout << std::setw(24) << map.name_ << std::setw(14) << build_single << std::setw(14) << build_parallel
+                  << std::setw(14) << manhattan_expanded << std::setw(14) << alt_expanded
+                  << std::setw(9) << double(manhattan_expanded) / alt_expanded << "x"
+                  << std::setw(14) << manhattan_ms << std::setw(14) << alt_ms << std::endl;
+    }
+    std::cout << "build N thr uses " << std::max(1u, std::thread::hardware_concurrency()) << " threads" << std::endl;
+}
+
+//-------------------------------------------------------------------------
+
+void pacman_bidirectional () {
+    using pacman_task::pacman_state_t;
+    using pacman_task::pacman_node_t;
+
+    std::cout << "Bidirectional search, expanded nodes summed over 20 random queries (ms)" << std::endl;
+    std::cout << std::setw(24) << "map" << std::setw(22) << "bfs" << std::setw(22) << "bidirectional bfs"
+              << std::setw(22) << "a*" << std::setw(22) << "bidirectional a*" << std::endl;
+
+    auto cell = [](size_t expanded, double ms) {
+        std::ostringstream out;
+        out << expanded << " (" << std::fixed << std::setprecision(2) << ms << ")";
+        return out.str();
+    };
+
+    std::mt19937 rng(11);
+    std::vector<PacmanMap> maps{maze_map(1001, 1001, rng), open_room_map(1000, 1000, rng, 30)};
+    for (auto const& map : maps) {
+        size_t expanded[4] = {0, 0, 0, 0};
+        double ms[4] = {0, 0, 0, 0};
+        for (auto const& q : random_queries(map, 20, rng)) {
+            size_t path_length[4];
+            bool found = true;
+            auto run = [&](int i, auto&& search) {
+                std::vector<pacman_state_t> result_path, explored_nodes;
+                Stopwatch sw;
+                found = search(result_path, explored_nodes);
+                ms[i] += sw.elapsed_ms();
+                expanded[i] += explored_nodes.size();
+                path_length[i] = result_path.size();
+            };
+            run(0, [&](auto& path, auto& explored) {
+                pacman_task::pacman_solve<std::queue<pacman_node_t>>(map.r_, map.c_, map.grid_, q.first, q.second, path, explored);
+                return true; });
+            run(1, [&](auto& path, auto& explored) {
+                return pacman_task::pacman_bidirectional_bfs_search(map.r_, map.c_, map.grid_, q.first, q.second, path, explored); });
+            run(2, [&](auto& path, auto& explored) {
+                pacman_task::pacman_solve<pacman_task::pacman_frontier_t>(map.r_, map.c_, map.grid_, q.first, q.second, path, explored,
+                                                                          a_star_search::ManhattanHeuristic<pacman_state_t>{q.second});
+                return true; });
+            run(3, [&](auto& path, auto& explored) {
+                return pacman_task::pacman_bidirectional_astar_search(map.r_, map.c_, map.grid_, q.first, q.second, path, explored); });
+
+            // a_star leaves a partial path when the food cannot be reached
+            if (found && (path_length[1] != path_length[0] || path_length[2] != path_length[0] || path_length[3] != path_length[0]))
+                failed_check() << "path length mismatch" << std::endl;
+        }
+
+        std::cout << std::setw(24) << map.name_;
+        for (int i = 0; i < 4; ++i)
+            std::cout << std::setw(22) << cell(expanded[i], ms[i]);
+        std::cout << std::endl;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+// JPS against BFS on small random grids: same reachability, same path length, and the path is a walk
+// over free cells from the start to the goal
+void check_jump_points ( int grids ) {
+    using pacman_task::pacman_state_t;
+
+    std::mt19937 rng(9);
+    int mismatches = 0;
+    for (int g = 0; g < grids; ++g) {
+        int r = 1 + int(rng() % 21), c = 1 + int(rng() % 21), wall_percent = int(rng() % 45);
+        std::vector<std::string> grid = random_grid(r, c, wall_percent, rng);
+        pacman_state_t start{int(rng() % r), int(rng() % c)}, goal{int(rng() % r), int(rng() % c)};
+
+        std::vector<pacman_state_t> bfs_path, bfs_explored, jps_path, jps_explored;
+        pacman_task::pacman_solve<std::queue<pacman_task::pacman_node_t>>(r, c, grid, start, goal, bfs_path, bfs_explored);
+        bool reachable = !bfs_path.empty() && bfs_path.front() == goal;
+        bool found = pacman_task::pacman_jps_search(r, c, grid, start, goal, std::back_inserter(jps_path), std::back_inserter(jps_explored));
+
+        bool ok = found == reachable;
+        if (ok && found) {
+            pacman_task::PacmanStateFilter filter{r, c, grid};
+            ok = jps_path.size() == bfs_path.size() && jps_path.front() == goal && jps_path.back() == start;
+            for (size_t i = 0; ok && i + 1 < jps_path.size(); ++i)
+                ok = filter(jps_path[i]) && std::abs(jps_path[i].first - jps_path[i + 1].first) + std::abs(jps_path[i].second - jps_path[i + 1].second) == 1;
+        }
+        mismatches += !ok;
+    }
+
+    // a start or a goal off the grid is not found
+    std::vector<std::string> grid(5, std::string(5, '-'));
+    for (auto const& ends : std::vector<std::pair<pacman_state_t, pacman_state_t>>{{{-1, 0}, {2, 2}}, {{0, 5}, {2, 2}}, {{2, 2}, {0, 6}}, {{2, 2}, {5, 0}}}) {
+        std::vector<pacman_state_t> path, explored;
+        mismatches += pacman_task::pacman_jps_search(5, 5, grid, ends.first, ends.second, std::back_inserter(path), std::back_inserter(explored));
+    }
+
+    std::cout << "JPS against BFS on " << grids << " random grids up to 21x21: " << mismatches << " mismatches" << std::endl;
+    if (mismatches != 0) {
+        failed_check() << "JPS paths differ from BFS" << std::endl;
+    }
+}
+
+void pacman_jump_points () {
+    using pacman_task::pacman_state_t;
+
+    check_jump_points(20000);
+
+    std::cout << "Jump Point Search against Manhattan A*, 20 random queries per map" << std::endl;
+    std::cout << std::setw(24) << "map" << std::setw(14) << "a* expanded" << std::setw(14) << "jps expanded"
+              << std::setw(10) << "fewer" << std::setw(12) << "a* ms" << std::setw(12) << "jps ms" << std::setw(10) << "speedup" << std::endl;
+
+    std::mt19937 rng(13);
+    std::vector<PacmanMap> maps{read_map("ucs_test_input.txt"), open_room_map(1000, 1000, rng, 0), open_room_map(1000, 1000, rng, 5),
+                                open_room_map(1000, 1000, rng, 20), maze_map(1001, 1001, rng)};
+    maps[1].name_ += " 0%";
+    maps[2].name_ += " 5%";
+    maps[3].name_ += " 20%";
+
+    for (auto const& map : maps) {
+        std::vector<std::pair<pacman_state_t, pacman_state_t>> queries{{map.start_, map.goal_}};
+        if (map.r_ > 100)
+            queries = random_queries(map, 20, rng);
+
+        size_t astar_expanded = 0, jps_expanded = 0;
+        double astar_ms = 0, jps_ms = 0;
+        for (auto const& q : queries) {
+            std::vector<pacman_state_t> astar_path, astar_explored, jps_path, jps_explored;
+            Stopwatch astar_sw;
+            pacman_task::pacman_solve<pacman_task::pacman_frontier_t>(map.r_, map.c_, map.grid_, q.first, q.second, astar_path, astar_explored,
+                                                                      a_star_search::ManhattanHeuristic<pacman_state_t>{q.second});
+            astar_ms += astar_sw.elapsed_ms();
+
+            Stopwatch jps_sw;
+            bool found = pacman_task::pacman_jps_search(map.r_, map.c_, map.grid_, q.first, q.second,
+                                                        std::back_inserter(jps_path), std::back_inserter(jps_explored));
+            jps_ms += jps_sw.elapsed_ms();
+
+            astar_expanded += astar_explored.size();
+            jps_expanded += jps_explored.size();
+            if (found && astar_path.size() != jps_path.size())
+                failed_check() << "path length mismatch: " << astar_path.size() << " vs " << jps_path.size() << std::endl;
+        }
+
+        std::cout << std::setw(24) << map.name_ << std::setw(14) << astar_expanded << std::setw(14) << jps_expanded
+                  << std::setw(9) << double(astar_expanded) / jps_expanded << "x"
+                  << std::setw(12) << astar_ms << std::setw(12) << jps_ms << std::setw(9) << astar_ms / jps_ms << "x" << std::endl;
+    }
+}
+
+// Parallel BFS against the sequential BFS on small random grids with 1 to 4 threads: same reachability,
+// same path length, and the path is a walk over free cells from the start to the goal
+void check_parallel_bfs ( int grids ) {
+    using pacman_task::pacman_state_t;
+
+    std::mt19937 rng(19);
+    int mismatches = 0;
+    for (int g = 0; g < grids; ++g) {
+        int r = 1 + int(rng() % 21), c = 1 + int(rng() % 21), wall_percent = int(rng() % 45);
+        std::vector<std::string> grid = random_grid(r, c, wall_percent, rng);
+        pacman_state_t start{int(rng() % r), int(rng() % c)}, goal{int(rng() % r), int(rng() % c)};
+        unsigned threads = 1 + rng() % 4;
+
+        pacman_task::PacmanStateFilter filter{r, c, grid};
+        std::vector<pacman_state_t> bfs_path, bfs_explored, parallel_path;
+        pacman_task::pacman_solve<std::queue<pacman_task::pacman_node_t>>(r, c, grid, start, goal, bfs_path, bfs_explored);
+        bool reachable = filter(start) && !bfs_path.empty() && bfs_path.front() == goal;
+        bool found = pacman_task::pacman_parallel_bfs_search(r, c, grid, start, goal, std::back_inserter(parallel_path), threads);
+
+        bool ok = found == reachable;
+        if (ok && found) {
+            ok = parallel_path.size() == bfs_path.size() && parallel_path.front() == goal && parallel_path.back() == start;
+            for (size_t i = 0; ok && i + 1 < parallel_path.size(); ++i)
+                ok = filter(parallel_path[i]) && std::abs(parallel_path[i].first - parallel_path[i + 1].first) + std::abs(parallel_path[i].second - parallel_path[i + 1].second) == 1;
+        }
+        mismatches += !ok;
+    }
+
+    // a start off the grid or on a wall and a goal off the grid are not found
+    std::vector<std::string> grid{"-----", "-%---", "-----", "-----", "-----"};
+    for (auto const& ends : std::vector<std::pair<pacman_state_t, pacman_state_t>>{{{-1, 0}, {2, 2}}, {{0, 5}, {2, 2}}, {{1, 1}, {2, 2}}, {{2, 2}, {0, 6}}, {{2, 2}, {5, 0}}}) {
+        std::vector<pacman_state_t> path;
+        mismatches += pacman_task::pacman_parallel_bfs_search(5, 5, grid, ends.first, ends.second, std::back_inserter(path), 2);
+    }
+
+    std::cout << "Parallel BFS against BFS on " << grids << " random grids up to 21x21: " << mismatches << " mismatches" << std::endl;
+    if (mismatches != 0) {
+        failed_check() << "parallel BFS paths differ from BFS" << std::endl;
+    }
+}
+
+// Level-synchronous BFS from 1 to hardware_concurrency threads against the sequential engine
+void pacman_parallel_bfs () {
+    using pacman_task::pacman_state_t;
+
+    check_parallel_bfs(5000);
+
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Parallel BFS, corner to corner, " << max_threads << " hardware threads" << std::endl;
+    std::cout << std::setw(24) << "map" << std::setw(10) << "threads" << std::setw(12) << "ms" << std::setw(10) << "speedup" << std::endl;
+
+    std::mt19937 rng(17);
+    std::vector<PacmanMap> maps{open_room_map(2000, 2000, rng, 20), open_room_map(4000, 4000, rng, 10)};
+
+    for (auto const& map : maps) {
+        size_t expanded = 0, path_length = 0;
+        double sequential = pacman_search_ms<std::queue<pacman_task::pacman_node_t>>(map, 1, expanded, path_length);
+        std::cout << std::setw(24) << map.name_ << std::setw(10) << "engine" << std::setw(12) << sequential << std::setw(10) << 1.0 << std::endl;
+
+        std::vector<unsigned> thread_counts;
+        for (unsigned t = 1; t < max_threads; t *= 2)
+            thread_counts.push_back(t);
+        thread_counts.push_back(max_threads);
+
+        for (unsigned threads : thread_counts) {
+            std::vector<pacman_state_t> path;
+            double ms = best_of(3, [&]() {
+                path.clear();
+                pacman_task::pacman_parallel_bfs_search(map.r_, map.c_, map.grid_, map.start_, map.goal_, std::back_inserter(path), threads);
+            });
+            if (path.size() - 1 != path_length)
+                failed_check() << "path length mismatch: " << path_length << " vs " << path.size() - 1 << std::endl;
+            std::cout << std::setw(24) << map.name_ << std::setw(10) << threads << std::setw(12) << ms << std::setw(10) << sequential / ms << std::endl;
+        }
+    }
+}
+
+// Direction-optimizing BFS against the queue BFS on small random grids: same cells in the same order
+// and the same reachability. A goal off the grid is not reached and a walled source explores nothing.
+void check_direction_optimizing_bfs ( int grids ) {
+    using pacman_task::pacman_state_t;
+
+    std::mt19937 rng(21);
+    int mismatches = 0;
+    for (int g = 0; g < grids; ++g) {
+        int r = 1 + int(rng() % 21), c = 1 + int(rng() % 21), wall_percent = int(rng() % 45);
+        std::vector<std::string> grid = random_grid(r, c, wall_percent, rng);
+        pacman_task::PacmanStateFilter filter{r, c, grid};
+        pacman_state_t start{int(rng() % r), int(rng() % c)}, goal{int(rng() % r), int(rng() % c)};
+        if (!filter(start))
+            continue;
+
+        std::vector<pacman_state_t> bfs_path, bfs_explored, explored;
+        pacman_task::pacman_solve<std::queue<pacman_task::pacman_node_t>>(r, c, grid, start, goal, bfs_path, bfs_explored);
+        bool reachable = !bfs_path.empty() && bfs_path.front() == goal;
+        pacman_task::PacmanDirectionOptimizingBfs bfs(filter);
+        bool found = bfs.search(start, &goal, std::back_inserter(explored));
+        mismatches += found != reachable || explored != bfs_explored;
+    }
+
+    std::vector<std::string> grid{"-----", "-%---", "-----", "-----", "-----"};
+    pacman_task::PacmanDirectionOptimizingBfs bfs(pacman_task::PacmanStateFilter{5, 5, grid});
+    for (auto const& ends : std::vector<std::pair<pacman_state_t, pacman_state_t>>{{{0, 0}, {0, 7}}, {{0, 0}, {5, 0}}, {{1, 1}, {0, 0}}, {{-1, 0}, {0, 0}}, {{0, 5}, {0, 0}}}) {
+        size_t explored = 0;
+        mismatches += bfs.search(ends.first, &ends.second, CountingIterator{&explored});
+        // an off-grid goal still explores the whole component of a valid source
+        mismatches += explored != (ends.first == pacman_state_t{0, 0} ? 24u : 0u);
+    }
+
+    std::cout << "Direction-optimizing BFS against BFS on " << grids << " random grids up to 21x21: " << mismatches << " mismatches" << std::endl;
+    if (mismatches != 0) {
+        failed_check() << "direction-optimizing BFS differs from BFS" << std::endl;
+    }
+}
+
+void pacman_direction_optimizing_bfs () {
+    using pacman_task::pacman_state_t;
+
+    check_direction_optimizing_bfs(5000);
+
+    std::cout << "Direction-optimizing bitmap BFS, corner to corner" << std::endl;
+    std::cout << std::setw(24) << "map" << std::setw(10) << "walls %" << std::setw(12) << "engine ms" << std::setw(12) << "bitmap ms"
+              << std::setw(10) << "speedup" << std::setw(12) << "top-down" << std::setw(12) << "bottom-up" << std::endl;
+
+    std::mt19937 rng(17);
+    for (int walls : {0, 5, 10, 15}) {
+        for (int size : {2000, 4000}) {
+            PacmanMap map = open_room_map(size, size, rng, walls);
+            size_t expanded = 0, path_length = 0;
+            double engine = pacman_search_ms<std::queue<pacman_task::pacman_node_t>>(map, 1, expanded, path_length);
+
+            pacman_task::PacmanDirectionOptimizingBfs bfs(pacman_task::PacmanStateFilter{map.r_, map.c_, map.grid_});
+            size_t explored = 0;
+            bool found = false;
+            double ms = best_of(3, [&]() {
+                explored = 0;
+                found = bfs.search(map.start_, &map.goal_, CountingIterator{&explored});
+            });
+            std::vector<pacman_state_t> path;
+            bfs.path(map.goal_, std::back_inserter(path));
+            if (explored != expanded || (found && path.size() - 1 != path_length))
+                failed_check() << "mismatch: " << expanded << "/" << path_length << " vs " << explored << "/" << path.size() - 1 << std::endl;
+
+            std::cout << std::setw(24) << map.name_ << std::setw(10) << walls << std::setw(12) << engine << std::setw(12) << ms
+                      << std::setw(10) << engine / ms << std::setw(12) << bfs.top_down_levels() << std::setw(12) << bfs.bottom_up_levels() << std::endl;
+        }
+    }
+}
+
+// Bit grid distance fields against the queue BFS on small random grids, sources off the grid or on a wall included
+void check_bit_grid ( int grids ) {
+    using pacman_task::pacman_state_t;
+
+    std::mt19937 rng(22);
+    int mismatches = 0;
+    for (int g = 0; g < grids; ++g) {
+        int r = 1 + int(rng() % 150), c = 1 + int(rng() % 150), wall_percent = int(rng() % 45);
+        std::vector<std::string> grid = random_grid(r, c, wall_percent, rng);
+        pacman_state_t source{int(rng() % (r + 2)) - 1, int(rng() % (c + 2)) - 1};
+
+        pacman_task::PacmanStateFilter filter{r, c, grid};
+        pacman_task::PacmanBitGrid bit_grid(filter);
+        std::vector<std::uint32_t> expected, scalar, vectorized;
+        pacman_task::pacman_distances(filter, source, expected);
+        bit_grid.distance_field(source, scalar, false);
+        bit_grid.distance_field(source, vectorized, true);
+        mismatches += scalar != expected || vectorized != expected
+                   || (!filter(source) && std::count(expected.begin(), expected.end(), pacman_task::PacmanBitGrid::unreachable) != r * c);
+    }
+
+    std::cout << "Bit grid distance fields against BFS on " << grids << " random grids up to 150x150: " << mismatches << " mismatches" << std::endl;
+    if (mismatches != 0) {
+        failed_check() << "bit grid distances differ from BFS" << std::endl;
+    }
+}
+
+void pacman_bit_grid () {
+    check_bit_grid(2000);
+
+    std::cout << "Full-map distance field from the start cell" << std::endl;
+    std::cout << std::setw(24) << "map" << std::setw(12) << "queue ms" << std::setw(12) << "words ms" << std::setw(12) << "avx2 ms"
+              << std::setw(10) << "speedup" << std::endl;
+
+    std::mt19937 rng(18);
+    std::vector<PacmanMap> maps{open_room_map(2000, 2000, rng, 0), open_room_map(2000, 2000, rng, 10), open_room_map(4000, 4000, rng, 10),
+                                maze_map(2001, 2001, rng)};
+    for (auto const& map : maps) {
+        pacman_task::PacmanStateFilter filter{map.r_, map.c_, map.grid_};
+        pacman_task::PacmanBitGrid bit_grid(filter);
+
+        std::vector<std::uint32_t> expected, scalar, vectorized;
+        double queue_ms = best_of(3, [&]() { pacman_task::pacman_distances(filter, map.start_, expected); });
+        double scalar_ms = best_of(3, [&]() { bit_grid.distance_field(map.start_, scalar, false); });
+        double vectorized_ms = best_of(3, [&]() { bit_grid.distance_field(map.start_, vectorized, true); });
+        if (scalar != expected || vectorized != expected)
+            failed_check() << "distance mismatch" << std::endl;
+
+        std::cout << std::setw(24) << map.name_ << std::setw(12) << queue_ms << std::setw(12) << scalar_ms << std::setw(12) << vectorized_ms
+                  << std::setw(10) << queue_ms / vectorized_ms << std::endl;
+    }
+}
+
+// MS-BFS and the nearest source against one queue BFS per source on small random grids. Up to 70 sources,
+// so some runs take two batches, drawn one cell around the grid so some are off it or on a wall.
+void check_multi_source_bfs ( int grids ) {
+    using pacman_task::pacman_state_t;
+    static constexpr std::uint32_t unreachable = pacman_task::PacmanLandmarks::unreachable;
+
+    std::mt19937 rng(23);
+    int mismatches = 0;
+    for (int g = 0; g < grids; ++g) {
+        int r = 1 + int(rng() % 21), c = 1 + int(rng() % 21), wall_percent = int(rng() % 45);
+        std::vector<std::string> grid = random_grid(r, c, wall_percent, rng);
+        pacman_task::PacmanStateFilter filter{r, c, grid};
+        std::vector<pacman_state_t> sources(1 + rng() % 70);
+        for (auto& source : sources)
+            source = {int(rng() % (r + 2)) - 1, int(rng() % (c + 2)) - 1};
+
+        std::vector<std::uint32_t> distances, nearest_distances, nearest, expected;
+        pacman_task::pacman_multi_source_distances(filter, sources, distances);
+        pacman_task::pacman_nearest_source(filter, sources, nearest_distances, nearest);
+
+        bool ok = true;
+        std::vector<std::uint32_t> best(std::size_t(r) * c, unreachable), best_source(best.size(), unreachable);
+        for (std::size_t s = 0; s < sources.size(); ++s) {
+            pacman_task::pacman_distances(filter, sources[s], expected);
+            for (std::size_t i = 0; i < expected.size(); ++i) {
+                ok = ok && distances[i * sources.size() + s] == expected[i];
+                if (expected[i] < best[i]) {
+                    best[i] = expected[i];
+                    best_source[i] = s;
+                }
+            }
+        }
+        mismatches += !ok || nearest_distances != best || nearest != best_source;
+    }
+
+    std::cout << "MS-BFS against BFS on " << grids << " random grids up to 21x21: " << mismatches << " mismatches" << std::endl;
+    if (mismatches != 0) {
+        failed_check() << "MS-BFS distances differ from BFS" << std::endl;
+    }
+}
+
+void pacman_multi_source_bfs () {
+    using pacman_task::pacman_state_t;
+
+    check_multi_source_bfs(2000);
+
+    std::cout << "Distances from 64 free cells spread over the map or packed into a square around its center" << std::endl;
+    std::cout << std::setw(24) << "map" << std::setw(10) << "square" << std::setw(14) << "64 BFS ms" << std::setw(14) << "MS-BFS ms"
+              << std::setw(10) << "speedup" << std::setw(14) << "nearest ms" << std::endl;
+
+    std::mt19937 rng(19);
+    std::vector<PacmanMap> maps{open_room_map(500, 500, rng, 10), open_room_map(1000, 1000, rng, 10), maze_map(501, 501, rng)};
+    for (auto const& map : maps) {
+        pacman_task::PacmanStateFilter filter{map.r_, map.c_, map.grid_};
+        for (int square : {std::min(map.r_, map.c_), 64, 16}) {
+            std::vector<pacman_state_t> sources;
+            while (sources.size() < 64) {
+                pacman_state_t cell{map.r_ / 2 - square / 2 + int(rng() % square), map.c_ / 2 - square / 2 + int(rng() % square)};
+                if (filter(cell))
+                    sources.push_back(cell);
+            }
+
+            std::vector<std::vector<std::uint32_t>> expected(sources.size());
+            double single_ms = best_of(1, [&]() {
+                for (std::size_t s = 0; s < sources.size(); ++s)
+                    pacman_task::pacman_distances(filter, sources[s], expected[s]);
+            });
+
+            std::vector<std::uint32_t> distances;
+            double multi_ms = best_of(3, [&]() { pacman_task::pacman_multi_source_distances(filter, sources, distances); });
+            for (std::size_t s = 0; s < sources.size(); ++s)
+                for (std::size_t i = 0; i < expected[s].size(); ++i)
+                    if (distances[i * sources.size() + s] != expected[s][i]) {
+                        failed_check() << "distance mismatch" << std::endl;
+                        s = sources.size();
+                        break;
+                    }
+
+            std::vector<std::uint32_t> nearest_distances, nearest;
+            double nearest_ms = best_of(3, [&]() { pacman_task::pacman_nearest_source(filter, sources, nearest_distances, nearest); });
+
+            std::cout << std::setw(24) << map.name_ << std::setw(10) << square << std::setw(14) << single_ms << std::setw(14) << multi_ms
+                      << std::setw(10) << single_ms / multi_ms << std::setw(14) << nearest_ms << std::endl;
+        }
+    }
+}
+
+void pacman_distance_field () {
+    using pacman_task::pacman_state_t;
+
+    std::cout << "Fixed food, 100 random pacman cells per map" << std::endl;
+    std::cout << std::setw(24) << "map" << std::setw(14) << "A* ms" << std::setw(14) << "build ms" << std::setw(14) << "queries ms"
+              << std::setw(14) << "rebuild ms" << std::setw(10) << "speedup" << std::endl;
+
+    // a food off the grid or on a wall cannot be reached, and cells off the grid cannot be changed
+    std::vector<std::string> grid{"-----", "-%---", "-----", "-----", "-----"};
+    for (pacman_state_t goal : {pacman_state_t{-1, 0}, pacman_state_t{0, 5}, pacman_state_t{5, 5}, pacman_state_t{1, 1}}) {
+        pacman_task::PacmanDistanceField field(pacman_task::PacmanStateFilter{5, 5, grid}, goal);
+        if (goal.first < 0 || goal.first >= 5 || goal.second >= 5)
+            field.set_cell(goal, '-');
+        std::vector<pacman_state_t> path;
+        if (field.distance({0, 0}) != pacman_task::PacmanLandmarks::unreachable || field.path({0, 0}, std::back_inserter(path)))
+            failed_check() << "food at (" << goal.first << ", " << goal.second << ") reached from (0, 0)" << std::endl;
+    }
+
+    std::mt19937 rng(20);
+    std::vector<PacmanMap> maps{open_room_map(300, 300, rng), maze_map(301, 301, rng), open_room_map(1000, 1000, rng), maze_map(1001, 1001, rng)};
+    for (auto const& map : maps) {
+        auto queries = random_queries(map, 100, rng);
+
+        double astar_ms = 0;
+        std::vector<size_t> expected;
+        for (auto const& q : queries) {
+            std::vector<pacman_state_t> result_path, explored_nodes;
+            Stopwatch sw;
+            pacman_task::pacman_solve<pacman_task::pacman_frontier_t>(map.r_, map.c_, map.grid_, q.first, map.goal_, result_path, explored_nodes,
+                                                                      a_star_search::ManhattanHeuristic<pacman_state_t>{map.goal_});
+            astar_ms += sw.elapsed_ms();
+            expected.push_back(result_path.front() == map.goal_ ? result_path.size() : 0);
+        }
+
+        Stopwatch build;
+        pacman_task::PacmanDistanceField field(pacman_task::PacmanStateFilter{map.r_, map.c_, map.grid_}, map.goal_);
+        double build_ms = build.elapsed_ms();
+
+        Stopwatch answer;
+        for (std::size_t q = 0; q < queries.size(); ++q) {
+            std::vector<pacman_state_t> path;
+            field.path(queries[q].first, std::back_inserter(path));
+            if (path.size() != expected[q])
+                failed_check() << "path length mismatch: " << expected[q] << " vs " << path.size() << std::endl;
+        }
+        double queries_ms = answer.elapsed_ms();
+
+        // a wall appears next to the food, the next query pays for the rebuild
+        field.set_cell({map.goal_.first, map.goal_.second - 1}, '%');
+        Stopwatch rebuild;
+        field.distance(map.start_);
+        double rebuild_ms = rebuild.elapsed_ms();
+
+        std::cout << std::setw(24) << map.name_ << std::setw(14) << astar_ms << std::setw(14) << build_ms << std::setw(14) << queries_ms
+                  << std::setw(14) << rebuild_ms << std::setw(10) << astar_ms / (build_ms + queries_ms) << std::endl;
+    }
+}
+
+// Batches of random queries on small random grids against one pacman_solve per query, with 1 to 4 threads.
+// Endpoints are drawn one cell around the grid; queries off the grid or on a wall get empty paths.
+void check_batch ( int grids ) {
+    using pacman_task::pacman_state_t;
+
+    std::mt19937 rng(24);
+    int mismatches = 0;
+    for (int g = 0; g < grids; ++g) {
+        int r = 1 + int(rng() % 40), c = 1 + int(rng() % 40), wall_percent = int(rng() % 45);
+        std::vector<std::string> grid = random_grid(r, c, wall_percent, rng);
+        pacman_task::PacmanStateFilter filter{r, c, grid};
+        std::vector<pacman_task::PacmanBatchSolver::Query> queries(1 + rng() % 100);
+        for (auto& q : queries) {
+            q.start_ = {int(rng() % (r + 2)) - 1, int(rng() % (c + 2)) - 1};
+            q.goal_ = {int(rng() % (r + 2)) - 1, int(rng() % (c + 2)) - 1};
+        }
+
+        pacman_task::PacmanBatchSolver solver(filter, 1 + rng() % 4);
+        std::vector<std::vector<pacman_state_t>> paths;
+        solver.solve(queries, paths);
+        for (std::size_t q = 0; q < queries.size(); ++q) {
+            std::vector<pacman_state_t> expected, explored_nodes;
+            pacman_task::pacman_solve<pacman_task::pacman_frontier_t>(r, c, grid, queries[q].start_, queries[q].goal_, expected, explored_nodes,
+                                                                      a_star_search::ManhattanHeuristic<pacman_state_t>{queries[q].goal_});
+            if (!filter(queries[q].start_) || expected.empty() || expected.front() != queries[q].goal_)
+                expected.clear();
+            mismatches += paths[q] != expected;
+        }
+    }
+
+    // pacman or the food off the grid or on a wall, then one query that is found
+    std::vector<std::string> grid{"-----", "-%---", "-----", "-----", "-----"};
+    std::vector<pacman_task::PacmanBatchSolver::Query> queries{{{-1, 0}, {2, 2}}, {{0, 5}, {2, 2}}, {{1, 1}, {2, 2}},
+                                                               {{2, 2}, {0, 7}}, {{2, 2}, {5, 0}}, {{2, 2}, {1, 1}}, {{0, 0}, {0, 2}}};
+    pacman_task::PacmanBatchSolver solver(pacman_task::PacmanStateFilter{5, 5, grid}, 2);
+    std::vector<std::vector<pacman_state_t>> paths;
+    solver.solve(queries, paths);
+    for (std::size_t q = 0; q + 1 < queries.size(); ++q)
+        mismatches += !paths[q].empty();
+    mismatches += paths.back().size() != 3;
+
+    std::cout << "Batch A* against pacman_solve on " << grids << " random grids up to 40x40: " << mismatches << " mismatches" << std::endl;
+    if (mismatches != 0) {
+        failed_check() << "batch paths differ from pacman_solve" << std::endl;
+    }
+}
+
+void pacman_batch () {
+    using pacman_task::pacman_state_t;
+
+    check_batch(2000);
+
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "Batch A* queries on one grid, " << max_threads << " hardware threads" << std::endl;
+    std::cout << std::setw(24) << "map" << std::setw(10) << "threads" << std::setw(14) << "queries/s" << std::setw(14) << "per thread" << std::endl;
+
+    std::mt19937 rng(21);
+    std::vector<PacmanMap> maps{open_room_map(100, 100, rng), maze_map(101, 101, rng), open_room_map(300, 300, rng), maze_map(301, 301, rng)};
+    for (auto const& map : maps) {
+        std::vector<pacman_task::PacmanBatchSolver::Query> queries;
+        for (auto const& q : random_queries(map, 2000, rng))
+            queries.push_back({q.first, q.second});
+
+        // one pacman_solve per query builds the visitor, the grid copy and the bitmaps every time
+        std::vector<std::vector<pacman_state_t>> expected(queries.size());
+        double single_ms = best_of(1, [&]() {
+            for (std::size_t q = 0; q < queries.size(); ++q) {
+                std::vector<pacman_state_t> explored_nodes;
+                expected[q].clear();
+                pacman_task::pacman_solve<pacman_task::pacman_frontier_t>(map.r_, map.c_, map.grid_, queries[q].start_, queries[q].goal_,
+                                                                          expected[q], explored_nodes,
+                                                                          a_star_search::ManhattanHeuristic<pacman_state_t>{queries[q].goal_});
+            }
+        });
+        std::cout << std::setw(24) << map.name_ << std::setw(10) << "solve" << std::setw(14) << queries.size() / single_ms * 1000
+                  << std::setw(14) << queries.size() / single_ms * 1000 << std::endl;
+
+        std::vector<unsigned> thread_counts;
+        for (unsigned t = 1; t < max_threads; t *= 2)
+            thread_counts.push_back(t);
+        thread_counts.push_back(max_threads);
+
+        for (unsigned threads : thread_counts) {
+            pacman_task::PacmanBatchSolver solver(pacman_task::PacmanStateFilter{map.r_, map.c_, map.grid_}, threads);
+            std::vector<std::vector<pacman_state_t>> paths;
+            double ms = best_of(3, [&]() { solver.solve(queries, paths); });
+            for (std::size_t q = 0; q < queries.size(); ++q)
+                if (paths[q] != (expected[q].front() == queries[q].goal_ ? expected[q] : std::vector<pacman_state_t>{})) {
+                    failed_check() << "path mismatch" << std::endl;
+                    break;
+                }
+
+            double per_second = queries.size() / ms * 1000;
+            std::cout << std::setw(24) << map.name_ << std::setw(10) << threads << std::setw(14) << per_second
+                      << std::setw(14) << per_second / threads << std::endl;
+        }
+    }
+}
+
+void pacman_grid_view () {
+    using pacman_task::pacman_state_t;
+
+    std::cout << "Short BFS queries on large maps, the grid passed as strings (copied per query) or as a shared view" << std::endl;
+    std::cout << std::setw(24) << "map" << std::setw(14) << "strings us" << std::setw(14) << "view us" << std::setw(10) << "speedup" << std::endl;
+
+    std::mt19937 rng(22);
+    for (int size : {1000, 2000, 4000}) {
+        PacmanMap map = open_room_map(size, size, rng);
+        pacman_task::GridView view(map.grid_);
+
+        std::vector<std::pair<pacman_state_t, pacman_state_t>> queries;
+        while (queries.size() < 200) {
+            pacman_state_t start{1 + int(rng() % (size - 12)), 1 + int(rng() % (size - 12))};
+            pacman_state_t goal{start.first + int(rng() % 10), start.second + int(rng() % 10)};
+            if (map.grid_[start.first][start.second] != '%' && map.grid_[goal.first][goal.second] != '%')
+                queries.emplace_back(start, goal);
+        }
+
+        auto run = [&](auto const& grid) {
+            return best_of(3, [&]() {
+                for (auto const& q : queries) {
+                    std::vector<pacman_state_t> result_path, explored_nodes;
+                    pacman_task::pacman_solve<std::queue<pacman_task::pacman_node_t>>(map.r_, map.c_, grid, q.first, q.second,
+                                                                                      result_path, explored_nodes);
+                }
+            }) * 1000 / queries.size();
+        };
+        double strings_us = run(map.grid_);
+        double view_us = run(view);
+
+        std::cout << std::setw(24) << map.name_ << std::setw(14) << strings_us << std::setw(14) << view_us
+                  << std::setw(10) << strings_us / view_us << std::endl;
+    }
+}
+
+void pacman_padded_grid () {
+    using pacman_task::pacman_state_t;
+
+    std::cout << "Corner to corner on (row, col) states with range checks or on cells of the padded grid" << std::endl;
+    std::cout << std::setw(24) << "map" << std::setw(8) << "search" << std::setw(12) << "expanded" << std::setw(14) << "pair ns/exp"
+              << std::setw(14) << "padded ns/exp" << std::setw(10) << "speedup" << std::endl;
+
+    // endpoints off the grid: (0, 7) would alias the padded cell of (1, 1), (-1, 0) is a border cell
+    std::vector<std::string> small{"-----", "-----", "-----", "-----", "-----"};
+    pacman_task::PacmanPaddedGrid small_grid(pacman_task::PacmanStateFilter{5, 5, small});
+    for (auto const& ends : std::vector<std::pair<pacman_state_t, pacman_state_t>>{{{0, 0}, {0, 7}}, {{0, 0}, {-1, 0}}, {{-1, 0}, {2, 2}}, {{0, 6}, {2, 2}}}) {
+        std::vector<pacman_state_t> pair_path, pair_explored, padded_path, padded_explored;
+        pacman_task::pacman_solve<std::queue<pacman_task::pacman_node_t>>(5, 5, small, ends.first, ends.second, pair_path, pair_explored);
+        pacman_task::pacman_padded_solve<std::queue<pacman_task::pacman_padded_node_t>>(small_grid, ends.first, ends.second, padded_path, padded_explored);
+        if (pair_path != padded_path || pair_explored != padded_explored)
+            failed_check() << "search mismatch from (" << ends.first.first << ", " << ends.first.second << ") to ("
+                           << ends.second.first << ", " << ends.second.second << ")" << std::endl;
+    }
+
+    std::mt19937 rng(23);
+    std::vector<PacmanMap> maps{open_room_map(2000, 2000, rng), open_room_map(4000, 4000, rng), maze_map(2001, 2001, rng)};
+    for (auto const& map : maps) {
+        pacman_task::PacmanPaddedGrid grid(pacman_task::PacmanStateFilter{map.r_, map.c_, map.grid_});
+
+        auto report = [&](char const* search, auto&& pair_search, auto&& padded_search) {
+            std::vector<pacman_state_t> pair_path, pair_explored, padded_path, padded_explored;
+            double pair_ms = best_of(3, [&]() {
+                pair_path.clear();
+                pair_explored.clear();
+                pair_search(pair_path, pair_explored);
+            });
+            double padded_ms = best_of(3, [&]() {
+                padded_path.clear();
+                padded_explored.clear();
+                padded_search(padded_path, padded_explored);
+            });
+            if (pair_path != padded_path || pair_explored.size() != padded_explored.size())
+                failed_check() << "search mismatch" << std::endl;
+
+            std::cout << std::setw(24) << map.name_ << std::setw(8) << search << std::setw(12) << pair_explored.size()
+                      << std::setw(14) << pair_ms * 1e6 / pair_explored.size() << std::setw(14) << padded_ms * 1e6 / padded_explored.size()
+                      << std::setw(10) << pair_ms / padded_ms << std::endl;
+        };
+
+        report("bfs", [&](auto& path, auto& explored) {
+            pacman_task::pacman_solve<std::queue<pacman_task::pacman_node_t>>(map.r_, map.c_, map.grid_, map.start_, map.goal_, path, explored);
+        }, [&](auto& path, auto& explored) {
+            pacman_task::pacman_padded_solve<std::queue<pacman_task::pacman_padded_node_t>>(grid, map.start_, map.goal_, path, explored);
+        });
+        report("astar", [&](auto& path, auto& explored) {
+            pacman_task::pacman_solve<pacman_task::pacman_frontier_t>(map.r_, map.c_, map.grid_, map.start_, map.goal_, path, explored,
+                                                                      a_star_search::ManhattanHeuristic<pacman_state_t>{map.goal_});
+        }, [&](auto& path, auto& explored) {
+            pacman_task::pacman_padded_solve<pacman_task::pacman_padded_frontier_t>(grid, map.start_, map.goal_, path, explored,
+                                                                                    pacman_task::PacmanPaddedManhattan(grid, grid.cell(map.goal_)));
+        });
+    }
+}
+
+// Allocations of a search on a new visitor and of the same search again on the cleared visitor.
+// The second search reuses the memory of the first, so any allocation in it comes from the hot loop.
+template <typename TVisitor, typename TState, typename FClear>
+void count_allocations ( std::string const& name, char const* search, TVisitor& visitor,
+                         TState const& start, TState const& goal, FClear&& clear, bool frontier_allocates = false ) {
+    size_t path_length = 0, expanded = 0;
+    size_t before = allocation_count;
+    a_star_search::a_star<TState>(start, goal, visitor, CountingIterator{&path_length}, CountingIterator{&expanded});
+    size_t cold = allocation_count - before;
+
+    clear();
+    path_length = expanded = 0;
+    before = allocation_count;
+    a_star_search::a_star<TState>(start, goal, visitor, CountingIterator{&path_length}, CountingIterator{&expanded});
+    size_t warm = allocation_count - before;
+
+    std::cout << std::setw(24) << name << std::setw(8) << search << std::setw(12) << expanded
+              << std::setw(14) << std::setprecision(4) << double(cold) / expanded << std::setw(10) << warm << std::endl;
+    // std::queue frees and allocates deque blocks as it goes, one per 64 pointers or so
+    if (frontier_allocates ? warm * 32 > expanded : warm != 0) {
+        failed_check() << search << " allocates in the expansion loop" << std::endl;
+    }
+}
+
+void pacman_allocations () {
+    using pacman_task::pacman_state_t;
+    using heuristic_t = a_star_search::ManhattanHeuristic<pacman_state_t>;
+
+    std::cout << "Heap allocations of a search on a new visitor and of the same search on the cleared visitor" << std::endl;
+    std::cout << std::setw(24) << "map" << std::setw(8) << "search" << std::setw(12) << "expanded"
+              << std::setw(14) << "cold per exp" << std::setw(10) << "warm" << std::endl;
+
+    std::mt19937 rng(24);
+    std::vector<PacmanMap> maps{open_room_map(1000, 1000, rng), maze_map(1001, 1001, rng)};
+    for (auto const& map : maps) {
+        pacman_task::PacmanStateFilter filter{map.r_, map.c_, map.grid_};
+        pacman_task::PacmanCellIndex index{map.r_, map.c_};
+        {
+            pacman_task::pacman_visitor_t<std::queue<pacman_task::pacman_node_t>> visitor(filter, {}, pacman_task::pacman_visited_t{index});
+            count_allocations(map.name_, "bfs", visitor, map.start_, map.goal_, [&]() { visitor.clear(); }, true);
+        }
+        {
+            pacman_task::pacman_visitor_t<pacman_task::pacman_frontier_t, heuristic_t> visitor(filter, heuristic_t{map.goal_}, pacman_task::pacman_visited_t{index},
+                                                                                               pacman_task::pacman_frontier_t{index});
+            count_allocations(map.name_, "astar", visitor, map.start_, map.goal_, [&]() { visitor.clear(heuristic_t{map.goal_}); });
+        }
+        {
+            using cell_t = pacman_task::PacmanPaddedGrid::cell_type;
+            using visited_t = a_star_search::BitmapVisitedSet<cell_t, pacman_task::PacmanPaddedIndex>;
+            pacman_task::PacmanPaddedGrid grid(filter);
+            pacman_task::PacmanPaddedIndex padded_index{grid.size()};
+            pacman_task::PacmanPaddedManhattan heuristic(grid, grid.cell(map.goal_));
+            a_star_search::NodeVisitor<cell_t, pacman_task::PacmanPaddedNeighborFunctor, pacman_task::PacmanPaddedFilter,
+                                       pacman_task::pacman_padded_frontier_t, pacman_task::PacmanPaddedManhattan, visited_t>
+                visitor(pacman_task::PacmanPaddedFilter{grid.data()}, heuristic, visited_t{padded_index},
+                        pacman_task::pacman_padded_frontier_t{padded_index}, pacman_task::PacmanPaddedNeighborFunctor{std::ptrdiff_t(grid.stride())});
+            count_allocations(map.name_, "padded", visitor, grid.cell(map.start_), grid.cell(map.goal_), [&]() { visitor.clear(heuristic); });
+        }
+    }
+}
+
+// Cache misses of the calling thread from the hardware counter, where the kernel lets us open it
+class CacheMissCounter {
+    int fd_ = -1;
+
+public:
+    CacheMissCounter () {
+#ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~CacheMissCounter () {
+        if (fd_ >= 0)
+            close(fd_);
+    }
+    CacheMissCounter ( CacheMissCounter const& ) = delete;
+    CacheMissCounter& operator= ( CacheMissCounter const& ) = delete;
+
+    bool available () const { return fd_ >= 0; }
+
+    // Misses while f runs, or -1 without a counter
+    template <typename F>
+    long long count ( F&& f ) {
+        long long misses = -1;
+#ifdef __linux__
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+            f();
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd_, &misses, sizeof(misses)) != sizeof(misses))
+                misses = -1;
+            return misses;
+        }
+#endif
+        f();
+        return misses;
+    }
+};
+
+void pacman_layout () {
+    using pacman_task::pacman_state_t;
+    using pacman_task::pacman_cell_t;
+
+    CacheMissCounter counter;
+    std::cout << "Searches from the start with the grid and the per-cell arrays in row-major or Z-order" << std::endl;
+    if (!counter.available())
+        std::cout << "no hardware cache miss counter here, only times are measured" << std::endl;
+    std::cout << std::setw(24) << "map" << std::setw(8) << "search" << std::setw(12) << "cells"
+              << std::setw(12) << "row ns/c" << std::setw(12) << "z ns/c" << std::setw(10) << "speedup"
+              << std::setw(14) << "row misses" << std::setw(14) << "z misses" << std::endl;
+
+    std::mt19937 rng(26);
+    std::vector<PacmanMap> maps{open_room_map(4000, 4000, rng), maze_map(4001, 4001, rng), open_room_map(16000, 1000, rng)};
+    for (auto const& map : maps) {
+        pacman_task::PacmanStateFilter filter{map.r_, map.c_, map.grid_};
+        pacman_task::PacmanLayoutGrid<pacman_task::PacmanRowMajorLayout> row_grid(filter);
+        pacman_task::PacmanLayoutGrid<pacman_task::PacmanMortonLayout> z_grid(filter);
+
+        auto report = [&](char const* search, auto&& row_search, auto&& z_search) {
+            size_t row_cells = 0, z_cells = 0;
+            double row_ms = best_of(3, [&]() { row_cells = row_search(); });
+            double z_ms = best_of(3, [&]() { z_cells = z_search(); });
+            long long row_misses = counter.count(row_search), z_misses = counter.count(z_search);
+            if (row_cells != z_cells) {
+                failed_check() << "the layouts reach different numbers of cells" << std::endl;
+            }
+
+            std::cout << std::setw(24) << map.name_ << std::setw(8) << search << std::setw(12) << row_cells
+                      << std::setw(12) << row_ms * 1e6 / row_cells << std::setw(12) << z_ms * 1e6 / z_cells
+                      << std::setw(10) << row_ms / z_ms;
+            if (row_misses < 0)
+                std::cout << std::setw(14) << "n/a" << std::setw(14) << "n/a" << std::endl;
+            else
+                std::cout << std::setw(14) << row_misses << std::setw(14) << z_misses << std::endl;
+        };
+
+        // the whole reachable area, with distance and parent arrays
+        std::vector<std::uint32_t> distances;
+        std::vector<pacman_cell_t> parents;
+        report("flood", [&]() {
+            return pacman_task::pacman_layout_bfs(row_grid, map.start_, distances, parents);
+        }, [&]() {
+            return pacman_task::pacman_layout_bfs(z_grid, map.start_, distances, parents);
+        });
+
+        // the engine with a bitmap visited set and nodes, until the goal
+        std::vector<pacman_state_t> row_path, row_explored, z_path, z_explored;
+        auto engine_bfs = [&](auto const& grid, std::vector<pacman_state_t>& path, std::vector<pacman_state_t>& explored) {
+            path.clear();
+            explored.clear();
+            pacman_task::pacman_layout_solve<std::queue<pacman_task::pacman_padded_node_t>>(grid, map.start_, map.goal_, path, explored);
+            return explored.size();
+        };
+        report("bfs", [&]() { return engine_bfs(row_grid, row_path, row_explored); },
+                      [&]() { return engine_bfs(z_grid, z_path, z_explored); });
+
+        // both layouts have to give exactly the path and the explored order of pacman_solve
+        std::vector<pacman_state_t> path, explored;
+        pacman_task::pacman_solve<std::queue<pacman_task::pacman_node_t>>(map.r_, map.c_, map.grid_, map.start_, map.goal_, path, explored);
+        if (row_path != path || row_explored != explored || z_path != path || z_explored != explored) {
+            failed_check() << "layout searches differ from pacman_solve" << std::endl;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+// Solvable boards made by a random walk of the blank from the goal
+npuzzle_task::puzzle_state_t scrambled_puzzle ( size_t k, int steps, std::mt19937& rng ) {
+    npuzzle_task::puzzle_grid_t goal(k, std::vector<size_t>(k));
+    for (size_t i = 0; i < k * k; ++i)
+        goal[i / k][i % k] = i;
+
+    npuzzle_task::puzzle_state_t state(goal);
+    for (int s = 0; s < steps; ++s) {
+        size_t d = rng() % 4;
+        if (state.can_move(d))
+            state.move(d);
+    }
+    return state;
+}
+
+template <typename TVisitedSet>
+double npuzzle_ns_per_expansion ( std::vector<npuzzle_task::puzzle_state_t> const& boards, npuzzle_task::puzzle_state_t const& goal ) {
+    size_t expanded = 0;
+    double ms = best_of(3, [&]() {
+        expanded = 0;
+        for (auto const& b : boards) {
+            size_t path_length = 0;
+            npuzzle_task::npuzzle_search<TVisitedSet>(b, goal, CountingIterator{&path_length}, CountingIterator{&expanded});
+        }
+    });
+    return ms * 1e6 / expanded;
+}
+
+void npuzzle_visited_sets () {
+    using npuzzle_task::puzzle_state_t;
+
+    std::cout << "N-puzzle visited set, ns per expansion" << std::endl;
+    std::cout << std::setw(6) << "k" << std::setw(12) << "tree" << std::setw(12) << "flat hash" << std::setw(10) << "speedup" << std::endl;
+
+    for (size_t k : {3, 4}) {
+        std::mt19937 rng(42);
+        std::vector<puzzle_state_t> boards;
+        for (int i = 0; i < 20; ++i)
+            boards.push_back(scrambled_puzzle(k, k == 3 ? 200 : 60, rng));
+
+        puzzle_state_t goal = scrambled_puzzle(k, 0, rng);
+
+        double tree = npuzzle_ns_per_expansion<a_star_search::TreeVisitedSet<puzzle_state_t>>(boards, goal);
+        double hash = npuzzle_ns_per_expansion<a_star_search::FlatHashSet<puzzle_state_t>>(boards, goal);
+        std::cout << std::setw(6) << k << std::setw(12) << tree << std::setw(12) << hash << std::setw(10) << tree / hash << std::endl;
+    }
+}
+
+// IDA* trades re-expansions for memory linear in the depth, A* stores every generated board
+void npuzzle_ida_star () {
+    using npuzzle_task::puzzle_state_t;
+
+    std::cout << "N-puzzle A* against IDA*" << std::endl;
+    std::cout << std::setw(6) << "k" << std::setw(14) << "A* ms" << std::setw(14) << "A* nodes"
+              << std::setw(14) << "IDA* ms" << std::setw(14) << "IDA* nodes" << std::setw(10) << "shorter" << std::endl;
+
+    for (size_t k : {3, 4}) {
+        std::mt19937 rng(7);
+        std::vector<puzzle_state_t> boards;
+        for (int i = 0; i < 20; ++i)
+            boards.push_back(scrambled_puzzle(k, k == 3 ? 200 : 60, rng));
+
+        puzzle_state_t goal = scrambled_puzzle(k, 0, rng);
+
+        std::vector<size_t> a_star_lengths, ida_star_lengths;
+        size_t a_star_nodes = 0, ida_star_nodes = 0;
+        double a_star_ms = best_of(1, [&]() {
+            a_star_lengths.clear();
+            a_star_nodes = 0;
+            for (auto const& b : boards) {
+                size_t path_length = 0;
+                npuzzle_task::npuzzle_search(b, goal, CountingIterator{&path_length}, CountingIterator{&a_star_nodes});
+                a_star_lengths.push_back(path_length - 1);
+            }
+        });
+        double ida_star_ms = best_of(1, [&]() {
+            ida_star_lengths.clear();
+            ida_star_nodes = 0;
+            npuzzle_task::PuzzleMoves moves;
+            npuzzle_task::PuzzleHeuristic heuristic;
+            for (auto const& b : boards) {
+                size_t moves_count = 0;
+                a_star_search::ida_star(b, goal, moves, heuristic, CountingIterator{&moves_count}, CountingIterator{&ida_star_nodes});
+                ida_star_lengths.push_back(moves_count);
+            }
+        });
+
+        // A* closes boards when they are pushed, so unlike IDA* it may miss the optimal solution
+        size_t shorter = 0;
+        for (size_t i = 0; i < boards.size(); ++i) {
+            if (ida_star_lengths[i] > a_star_lengths[i])
+                std::cout << "IDA* solution is longer than A* one for k = " << k << std::endl;
+            shorter += ida_star_lengths[i] < a_star_lengths[i];
+        }
+        std::cout << std::setw(6) << k << std::setw(14) << a_star_ms << std::setw(14) << a_star_nodes
+                  << std::setw(14) << ida_star_ms << std::setw(14) << ida_star_nodes << std::setw(10) << shorter << std::endl;
+    }
+}
+
+// Hard 15-puzzle instances from Korf's test set (1985), optimal solutions of 57, 55 and 59 moves
+npuzzle_task::puzzle_grid_t const korf_puzzles[] = {
+    {{14, 13, 15,  7}, {11, 12,  9,  5}, { 6,  0,  2,  1}, { 4,  8, 10,  3}},
+    {{13,  5,  4, 10}, { 9, 12,  8, 14}, { 2,  3,  7,  1}, { 0, 15, 11,  6}},
+    {{14,  7,  8,  2}, {13, 11, 10,  4}, { 9, 12,  5,  0}, { 3,  6,  1, 15}},
+};
+
+template <typename FHeuristic>
+double npuzzle_ida_star_ms ( std::vector<npuzzle_task::puzzle_state_t> const& boards, npuzzle_task::puzzle_state_t const& goal,
+                             FHeuristic heuristic, std::vector<size_t>& lengths, size_t& expanded ) {
+    return best_of(1, [&]() {
+        lengths.clear();
+        expanded = 0;
+        npuzzle_task::PuzzleMoves moves;
+        for (auto const& b : boards) {
+            size_t moves_count = 0;
+            a_star_search::ida_star(b, goal, moves, heuristic, CountingIterator{&moves_count}, CountingIterator{&expanded});
+            lengths.push_back(moves_count);
+        }
+    });
+}
+
+void npuzzle_pattern_database () {
+    using npuzzle_task::puzzle_state_t;
+
+    std::string file_name = std::string(NPUZZLE_PDB_DIR) + "/" + npuzzle_task::npuzzle_pdb_file(4);
+    npuzzle_task::PuzzlePatternDatabase database;
+    Stopwatch load;
+    try {
+        database = npuzzle_task::PuzzlePatternDatabase::load(file_name);
+    } catch (std::runtime_error const& e) {
+        std::cout << "N-puzzle pattern database: " << e.what() << ", build the npuzzle_pdb target first" << std::endl;
+        return;
+    }
+
+    std::cout << "15-puzzle IDA*, Manhattan against 6-6-3 pattern database (mapped in "
+              << load.elapsed_ms() << " ms)" << std::endl;
+    std::cout << std::setw(10) << "boards" << std::setw(14) << "h" << std::setw(12) << "ms" << std::setw(14) << "nodes" << std::endl;
+
+    std::mt19937 rng(11);
+    std::vector<puzzle_state_t> boards;
+    for (int i = 0; i < 20; ++i)
+        boards.push_back(scrambled_puzzle(4, 100, rng));
+    puzzle_state_t goal = scrambled_puzzle(4, 0, rng);
+
+    std::vector<size_t> manhattan_lengths, pdb_lengths;
+    size_t manhattan_nodes = 0, pdb_nodes = 0;
+    double manhattan_ms = npuzzle_ida_star_ms(boards, goal, npuzzle_task::PuzzleHeuristic{}, manhattan_lengths, manhattan_nodes);
+    double pdb_ms = npuzzle_ida_star_ms(boards, goal, npuzzle_task::PuzzlePatternHeuristic{&database}, pdb_lengths, pdb_nodes);
+    if (manhattan_lengths != pdb_lengths)
+        failed_check() << "solution length mismatch" << std::endl;
+    std::cout << std::setw(10) << "random" << std::setw(14) << "manhattan" << std::setw(12) << manhattan_ms << std::setw(14) << manhattan_nodes << std::endl;
+    std::cout << std::setw(10) << "random" << std::setw(14) << "pdb 6-6-3" << std::setw(12) << pdb_ms << std::setw(14) << pdb_nodes << std::endl;
+
+    // Manhattan distance needs hundreds of millions of nodes on these
+    std::vector<puzzle_state_t> korf;
+    for (auto const& grid : korf_puzzles)
+        korf.emplace_back(grid);
+    pdb_ms = npuzzle_ida_star_ms(korf, goal, npuzzle_task::PuzzlePatternHeuristic{&database}, pdb_lengths, pdb_nodes);
+    if (pdb_lengths != std::vector<size_t>{57, 55, 59})
+        failed_check() << "solution length mismatch" << std::endl;
+    std::cout << std::setw(10) << "korf 1-3" << std::setw(14) << "pdb 6-6-3" << std::setw(12) << pdb_ms << std::setw(14) << pdb_nodes << std::endl;
+}
+
+// Hides the delta form, so the engine evaluates every state from scratch
+template <typename FHeuristic>
+struct FullHeuristic {
+    FHeuristic heuristic_;
+
+    template <typename TState>
+    int operator() ( TState const& state ) { return heuristic_(state); }
+};
+
+void npuzzle_incremental_heuristics () {
+    using npuzzle_task::puzzle_state_t;
+
+    std::cout << "15-puzzle IDA*, full against incremental heuristic evaluation" << std::endl;
+    std::cout << std::setw(18) << "h" << std::setw(12) << "full ms" << std::setw(12) << "delta ms"
+              << std::setw(10) << "speedup" << std::setw(14) << "nodes" << std::endl;
+
+    std::mt19937 rng(11);
+    std::vector<puzzle_state_t> boards;
+    for (int i = 0; i < 20; ++i)
+        boards.push_back(scrambled_puzzle(4, 100, rng));
+    puzzle_state_t goal = scrambled_puzzle(4, 0, rng);
+
+    auto compare = [&](char const* name, auto heuristic) {
+        std::vector<size_t> full_lengths, delta_lengths;
+        size_t full_nodes = 0, delta_nodes = 0;
+        double full_ms = npuzzle_ida_star_ms(boards, goal, FullHeuristic<decltype(heuristic)>{heuristic}, full_lengths, full_nodes);
+        double delta_ms = npuzzle_ida_star_ms(boards, goal, heuristic, delta_lengths, delta_nodes);
+        if (full_lengths != delta_lengths || full_nodes != delta_nodes)
+            failed_check() << "search mismatch" << std::endl;
+        std::cout << std::setw(18) << name << std::setw(12) << full_ms << std::setw(12) << delta_ms
+                  << std::setw(10) << full_ms / delta_ms << std::setw(14) << delta_nodes << std::endl;
+        return 0;
+    };
+    compare("manhattan", npuzzle_task::PuzzleHeuristic{});
+    compare("linear conflict", npuzzle_task::PuzzleLinearConflictHeuristic{});
+}
+
+// ns per full evaluation of a random 4x4 board
+template <typename FEvaluate>
+double npuzzle_ns_per_evaluation ( std::vector<npuzzle_task::puzzle_state_t> const& boards, FEvaluate evaluate, long& checksum ) {
+    double ms = best_of(5, [&]() {
+        checksum = 0;
+        for (auto const& b : boards)
+            checksum += evaluate(b);
+    });
+    return ms * 1e6 / boards.size();
+}
+
+void npuzzle_simd_kernels () {
+    using npuzzle_task::puzzle_state_t;
+
+#ifdef NPUZZLE_HAS_AVX2_KERNELS
+    if (!npuzzle_task::puzzle_has_avx2()) {
+        std::cout << "N-puzzle SIMD kernels: no AVX2 on this CPU" << std::endl;
+        return;
+    }
+
+    std::mt19937 rng(5);
+    std::vector<puzzle_state_t> boards;
+    for (int i = 0; i < 1000000; ++i)
+        boards.push_back(scrambled_puzzle(4, 200, rng));
+    using scalar_h = npuzzle_task::PuzzleHeuristic;
+    using scalar_lc = npuzzle_task::PuzzleLinearConflictHeuristic;
+
+    std::cout << "15-puzzle full evaluation, ns per board" << std::endl;
+    std::cout << std::setw(18) << "kernel" << std::setw(12) << "scalar" << std::setw(12) << "avx2" << std::setw(10) << "speedup" << std::endl;
+
+    long scalar_sum = 0, simd_sum = 0;
+    double scalar = npuzzle_ns_per_evaluation(boards, [](puzzle_state_t const& b) { return scalar_h::scalar(b); }, scalar_sum);
+    double simd = npuzzle_ns_per_evaluation(boards, [](puzzle_state_t const& b) { return npuzzle_task::puzzle_manhattan_avx2(b.word(), b.k()); }, simd_sum);
+    if (scalar_sum != simd_sum)
+        failed_check() << "manhattan mismatch" << std::endl;
+    std::cout << std::setw(18) << "manhattan" << std::setw(12) << scalar << std::setw(12) << simd << std::setw(10) << scalar / simd << std::endl;
+
+    scalar = npuzzle_ns_per_evaluation(boards, [](puzzle_state_t const& b) { return scalar_lc::scalar_conflicts(b); }, scalar_sum);
+    simd = npuzzle_ns_per_evaluation(boards, [](puzzle_state_t const& b) { return npuzzle_task::puzzle_linear_conflicts_avx2(b.word(), b.k()); }, simd_sum);
+    if (scalar_sum != simd_sum)
+        failed_check() << "linear conflict mismatch" << std::endl;
+    std::cout << std::setw(18) << "linear conflict" << std::setw(12) << scalar << std::setw(12) << simd << std::setw(10) << scalar / simd << std::endl;
+#else
+    std::cout << "N-puzzle SIMD kernels: not an x86-64 build" << std::endl;
+#endif
+}
+
+// HDA* speedup and search overhead (expansions against one thread) per thread count
+void npuzzle_hda_star () {
+    using npuzzle_task::puzzle_state_t;
+
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> thread_counts{1, 2, 4};
+    if (max_threads > 4)
+        thread_counts.push_back(max_threads);
+
+    std::cout << "15-puzzle HDA* with linear conflicts, " << max_threads << " hardware threads" << std::endl;
+    std::cout << std::setw(10) << "threads" << std::setw(12) << "ms" << std::setw(10) << "speedup" << std::setw(14) << "expanded"
+              << std::setw(10) << "overhead" << std::setw(14) << "messages" << std::endl;
+
+    std::mt19937 rng(23);
+    std::vector<puzzle_state_t> boards;
+    for (int i = 0; i < 10; ++i)
+        boards.push_back(scrambled_puzzle(4, 300, rng));
+    puzzle_state_t goal = scrambled_puzzle(4, 0, rng);
+
+    double base_ms = 0;
+    size_t base_expanded = 0;
+    std::vector<size_t> base_lengths;
+    for (unsigned threads : thread_counts) {
+        size_t expanded = 0, messages = 0;
+        std::vector<size_t> lengths;
+        double ms = best_of(1, [&]() {
+            for (auto const& b : boards) {
+                size_t path_length = 0;
+                a_star_search::HdaStarStats stats;
+                npuzzle_task::npuzzle_hda_star_search(b, goal, threads, CountingIterator{&path_length}, &stats);
+                lengths.push_back(path_length - 1);
+                expanded += std::accumulate(stats.expanded_.begin(), stats.expanded_.end(), size_t(0));
+                messages += stats.messages_;
+            }
+        });
+        if (threads == 1) {
+            base_ms = ms;
+            base_expanded = expanded;
+            base_lengths = lengths;
+        }
+        if (lengths != base_lengths)
+            failed_check() << "solution length mismatch" << std::endl;
+        std::cout << std::setw(10) << threads << std::setw(12) << ms << std::setw(10) << base_ms / ms << std::setw(14) << expanded
+                  << std::setw(10) << double(expanded) / base_expanded << std::setw(14) << messages << std::endl;
+    }
+}
+
+} // namespace pacman_benchmark
+
+int main(int argc, char** argv) {
+    using benchmark_t = std::pair<char const*, void(*)()>;
+    benchmark_t const benchmarks[] = {
+        {"npuzzle_visited_sets", pacman_benchmark::npuzzle_visited_sets},
+        {"npuzzle_ida_star", pacman_benchmark::npuzzle_ida_star},
+        {"npuzzle_pattern_database", pacman_benchmark::npuzzle_pattern_database},
+        {"npuzzle_incremental_heuristics", pacman_benchmark::npuzzle_incremental_heuristics},
+        {"npuzzle_simd_kernels", pacman_benchmark::npuzzle_simd_kernels},
+        {"npuzzle_hda_star", pacman_benchmark::npuzzle_hda_star},
+        {"pacman_frontiers", pacman_benchmark::pacman_frontiers},
+        {"pacman_heuristics", pacman_benchmark::pacman_heuristics},
+        {"pacman_landmarks", pacman_benchmark::pacman_landmarks},
+        {"pacman_bidirectional", pacman_benchmark::pacman_bidirectional},
+        {"pacman_jump_points", pacman_benchmark::pacman_jump_points},
+        {"pacman_parallel_bfs", pacman_benchmark::pacman_parallel_bfs},
+        {"pacman_direction_optimizing_bfs", pacman_benchmark::pacman_direction_optimizing_bfs},
+        {"pacman_bit_grid", pacman_benchmark::pacman_bit_grid},
+        {"pacman_multi_source_bfs", pacman_benchmark::pacman_multi_source_bfs},
+        {"pacman_distance_field", pacman_benchmark::pacman_distance_field},
+        {"pacman_batch", pacman_benchmark::pacman_batch},
+        {"pacman_grid_view", pacman_benchmark::pacman_grid_view},
+        {"pacman_padded_grid", pacman_benchmark::pacman_padded_grid},
+        {"pacman_allocations", pacman_benchmark::pacman_allocations},
+        {"pacman_layout", pacman_benchmark::pacman_layout},
+    };
+
+    std::cout << std::fixed << std::setprecision(2);
+    for (auto const& b : benchmarks) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i)
+            selected = selected || std::strcmp(argv[i], b.first) == 0;
+
+        if (selected) {
+            b.second();
+            std::cout << std::endl;
+        }
+    }
+    return pacman_benchmark::failed_checks == 0 ? 0 : 1;
+}
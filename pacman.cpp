@@ -4,9 +4,34 @@
 #include <set>
 #include <stack>
 #include <queue>
+#include <map>
+#include <unordered_map>
 #include <memory>
 #include <type_traits>
 #include <algorithm>
+#include <iterator>
+#include <limits>
+#include <cstdint>
+#include <stdexcept>
+#include <cstdlib>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <numeric>
+#include <functional>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 namespace a_star_search {
 
@@ -15,6 +40,50 @@ struct DefaultHeuristic {
     T operator()( TState const& ) { return T(0); }
 };
 
+// Admissible heuristics for grid states given as (row, col) pairs
+
+// Exact distance on an empty 4-connected grid
+template <typename TState, typename T = int>
+struct ManhattanHeuristic {
+    TState goal_;
+
+    T operator()( TState const& state ) const {
+        return T(std::abs(state.first - goal_.first) + std::abs(state.second - goal_.second));
+    }
+};
+
+// Maximum of admissible heuristics is admissible and at least as informed as each of them
+template <typename... THeuristics>
+struct MaxOfHeuristic;
+
+template <typename THeuristic>
+struct MaxOfHeuristic<THeuristic> {
+    THeuristic heuristic_;
+
+    MaxOfHeuristic (THeuristic const& heuristic) : heuristic_(heuristic) {}
+
+    template <typename TState>
+    auto operator()( TState const& state ) -> decltype(heuristic_(state)) { return heuristic_(state); }
+};
+
+template <typename THeuristic, typename... TRest>
+struct MaxOfHeuristic<THeuristic, TRest...> {
+    THeuristic heuristic_;
+    MaxOfHeuristic<TRest...> rest_;
+
+    MaxOfHeuristic (THeuristic const& heuristic, TRest const&... rest) : heuristic_(heuristic)
+                                                                       , rest_(rest...) {}
+
+    template <typename TState>
+    auto operator()( TState const& state ) -> typename std::common_type<decltype(heuristic_(state)), decltype(rest_(state))>::type {
+        using T = typename std::common_type<decltype(heuristic_(state)), decltype(rest_(state))>::type;
+        return std::max<T>(heuristic_(state), rest_(state));
+    }
+};
+
+template <typename... THeuristics>
+MaxOfHeuristic<THeuristics...> max_of ( THeuristics const&... heuristics ) { return MaxOfHeuristic<THeuristics...>(heuristics...); }
+
 //TODO: TState shoudl have operator== 
 template < typename TState,
            typename TScore = int >
@@ -26,37 +95,506 @@ class Node {
 
 public:
     using value_type = TState;
+    using score_type = TScore;
+    // nodes live in a node store and refer to each other by position in it
+    using index_type = std::uint32_t;
+    static constexpr index_type npos = std::numeric_limits<index_type>::max();
 
     TState state_;
-    std::shared_ptr<Node> parent_;
+    index_type index_;
+    index_type parent_;
 
 public: 
     Node() = delete;
     Node( Node const& ) = delete;
     
-    Node(TState state, TScore h_score = TScore(0)) : g_score_(0)
-                                                   , h_score_(h_score)
-                                                   , state_(state)
-                                                   , parent_(nullptr) {}; 
-
-    Node(TState state, 
-         std::shared_ptr<Node> parent,
-         TScore h_score = TScore(0)) : g_score_(parent->g_score_ + 1)
-                                     , h_score_(h_score)
-                                     , state_(state)
-                                     , parent_(parent) {};
+    Node(index_type index, TState state, TScore h_score = TScore(0)) : g_score_(0)
+                                                                     , h_score_(h_score)
+                                                                     , state_(state)
+                                                                     , index_(index)
+                                                                     , parent_(npos) {}; 
+
+    Node(index_type index, TState state,
+         Node const& parent,
+         TScore h_score = TScore(0),
+         TScore step_cost = TScore(1)) : g_score_(parent.g_score_ + step_cost)
+                                       , h_score_(h_score)
+                                       , state_(state)
+                                       , index_(index)
+                                       , parent_(parent.index_) {};
 
     TScore get_total_score() const {return h_score_ + g_score_;};
+    TScore get_g_score() const {return g_score_;};
+    TScore get_h_score() const {return h_score_;};
+
+    // Moves the node under a parent that reaches it cheaper
+    void reparent(Node const& parent, TScore step_cost = TScore(1)) {
+        g_score_ = parent.g_score_ + step_cost;
+        parent_ = parent.index_;
+    }
+};
+
+template <typename TState>
+using NodePtr = Node<TState>*;
+
+// Owns all nodes generated during one search.
+// Nodes are bump-allocated in fixed-size blocks, so they never move once created
+// and the containers can hold plain pointers to them. Parents are referenced by 32-bit index.
+// Everything is released at once by clear() (blocks are kept for the next search) or by the destructor.
+template <typename TNode>
+class NodeArena {
+public:
+    using node_type = TNode;
+    using index_type = typename TNode::index_type;
+
+private:
+    static constexpr std::size_t block_bits_ = 12;
+    static constexpr std::size_t block_mask_ = (std::size_t(1) << block_bits_) - 1;
+
+    using storage_t = typename std::aligned_storage<sizeof(TNode), alignof(TNode)>::type;
+
+    std::vector<std::unique_ptr<storage_t[]>> blocks_;
+    index_type size_{0};
+
+public:
+    NodeArena () = default;
+    NodeArena (NodeArena const&) = delete;
+    ~NodeArena () { clear(); }
+
+    template <typename... TArgs>
+    TNode* emplace (TArgs&&... args) {
+        if (size_ == TNode::npos)
+            throw std::length_error("NodeArena: node index overflow");
+
+        std::size_t block = size_ >> block_bits_;
+        if (block == blocks_.size())
+            blocks_.emplace_back(new storage_t[block_mask_ + 1]);
+
+        TNode* node = new (&blocks_[block][size_ & block_mask_]) TNode(size_, std::forward<TArgs>(args)...);
+        ++size_;
+        return node;
+    }
+
+    TNode* operator[] (index_type index) const {
+        return reinterpret_cast<TNode*>(&blocks_[index >> block_bits_][index & block_mask_]);
+    }
+
+    TNode* parent (TNode const& node) const { return node.parent_ == TNode::npos ? nullptr : (*this)[node.parent_]; }
+
+    index_type size () const { return size_; }
+
+    void clear () {
+        if (!std::is_trivially_destructible<TNode>::value)
+            for (index_type i = 0; i < size_; ++i)
+                (*this)[i]->~TNode();
+        size_ = 0;
+    }
+};
+
+// Visited set policies for NodeVisitor.
+// A policy answers contains(state) and records insert(state).
+
+// Fallback for any totally ordered state
+template <typename TState>
+class TreeVisitedSet {
+    std::set<TState, std::less<>> visited_;
+
+public:
+    bool contains (TState const& state) const { return visited_.find(state) != visited_.end(); }
+    void insert (TState const& state) { visited_.insert(state); }
+    void clear () { visited_.clear(); }
+};
+
+// One bit per state for bounded state spaces, e.g. cells of a grid.
+// FStateIndex maps a state to [0, size()) and reports size().
+template <typename TState, typename FStateIndex>
+class BitmapVisitedSet {
+    FStateIndex index_;
+    std::vector<std::uint64_t> bits_;
+
+public:
+    BitmapVisitedSet (FStateIndex const& index) : index_(index)
+                                                , bits_((index_.size() + 63) / 64, 0) {}
+
+    bool contains (TState const& state) const {
+        std::size_t i = index_(state);
+        return (bits_[i >> 6] >> (i & 63)) & 1;
+    }
+
+    void insert (TState const& state) {
+        std::size_t i = index_(state);
+        bits_[i >> 6] |= std::uint64_t(1) << (i & 63);
+    }
+
+    void clear () { std::fill(bits_.begin(), bits_.end(), 0); }
+};
+
+template <typename... Ts> struct make_void { using type = void; };
+template <typename... Ts> using void_t = typename make_void<Ts...>::type;
+
+// Hash of a search state. By default it is std::hash,
+// specialize it for states std::hash does not cover.
+template <typename TState, typename = void>
+struct StateHash {};
+
+template <typename TState>
+struct StateHash<TState, void_t<decltype(std::hash<TState>{}(std::declval<TState const&>()))>> : std::hash<TState> {};
+
+// A state is hashable when THash maps it to something convertible to std::size_t
+template <typename TState, typename THash = StateHash<TState>, typename = void>
+struct is_hashable : std::false_type {};
+
+template <typename TState, typename THash>
+struct is_hashable<TState, THash, void_t<decltype(std::declval<THash&>()(std::declval<TState const&>()))>>
+    : std::is_convertible<decltype(std::declval<THash&>()(std::declval<TState const&>())), std::size_t> {};
+
+// Open addressing set with Robin Hood probing for hashable states.
+// Keys are kept in one flat array next to their probe distance and a part of the hash,
+// so most failed comparisons never touch the state itself. TState has to be default constructible.
+template <typename TState, typename THash = StateHash<TState>>
+class FlatHashSet {
+    static_assert(is_hashable<TState, THash>::value, "FlatHashSet: THash has to map TState to std::size_t");
+
+    struct Slot {
+        std::uint32_t hash_;
+        // distance from the home slot plus one, 0 marks an empty slot
+        std::uint32_t dist_;
+    };
+
+    THash hash_;
+    std::vector<Slot> slots_;
+    std::vector<TState> keys_;
+    std::size_t size_{0};
+    unsigned bits_{3};
+
+    std::uint64_t mix (TState const& state) const { return std::uint64_t(hash_(state)) * 0x9E3779B97F4A7C15ull; }
+    std::size_t home (std::uint64_t h) const { return std::size_t(h >> (64 - bits_)); }
+    std::size_t mask () const { return slots_.size() - 1; }
+
+    void grow () {
+        std::vector<Slot> slots(std::size_t(1) << ++bits_, Slot{0, 0});
+        std::vector<TState> keys(slots.size());
+        slots_.swap(slots);
+        keys_.swap(keys);
+        size_ = 0;
+        for (std::size_t i = 0; i < slots.size(); ++i) {
+            if (slots[i].dist_ == 0)
+                continue;
+            std::uint64_t h = mix(keys[i]);
+            insert_unique(std::move(keys[i]), h);
+        }
+    }
+
+    void insert_unique (TState state, std::uint64_t h) {
+        Slot slot{std::uint32_t(h), 1};
+        for (std::size_t i = home(h);; i = (i + 1) & mask(), ++slot.dist_) {
+            if (slots_[i].dist_ == 0) {
+                slots_[i] = slot;
+                keys_[i] = std::move(state);
+                ++size_;
+                return;
+            }
+            // take the slot from a richer key and continue with it
+            if (slots_[i].dist_ < slot.dist_) {
+                std::swap(slots_[i], slot);
+                std::swap(keys_[i], state);
+            }
+        }
+    }
+
+public:
+    FlatHashSet (THash const& hash = THash()) : hash_(hash) { grow(); }
+
+    bool contains (TState const& state) const {
+        std::uint64_t h = mix(state);
+        std::uint32_t dist = 1;
+        for (std::size_t i = home(h);; i = (i + 1) & mask(), ++dist) {
+            Slot const& s = slots_[i];
+            // a key always sits before any richer one, so the search can stop here
+            if (s.dist_ < dist)
+                return false;
+            if (s.dist_ == dist && s.hash_ == std::uint32_t(h) && keys_[i] == state)
+                return true;
+        }
+    }
+
+    void insert (TState const& state) {
+        if (contains(state))
+            return;
+        // keep the load factor under 7/8
+        if ((size_ + 1) * 8 > slots_.size() * 7)
+            grow();
+        insert_unique(state, mix(state));
+    }
+
+    std::size_t size () const { return size_; }
+
+    void clear () {
+        std::fill(slots_.begin(), slots_.end(), Slot{0, 0});
+        size_ = 0;
+    }
 };
 
+// Hashable states get the flat hash set, everything else the tree
 template <typename TState>
-using NodePtr = std::shared_ptr< Node<TState>>;
+using DefaultVisitedSet = typename std::conditional<is_hashable<TState>::value,
+                                                    FlatHashSet<TState>,
+                                                    TreeVisitedSet<TState>>::type;
+
+// Total score of a node, the key of priority frontiers
+struct NodeTotalScore {
+    template <typename TNodePtr>
+    auto operator() ( TNodePtr const& node ) const -> decltype(node->get_total_score()) { return node->get_total_score(); }
+};
+
+// Total score with ties broken towards deeper nodes, which are closer to the goal when the heuristic is good
+struct NodeScoreDeepestFirst {
+    template <typename TNodePtr>
+    auto operator() ( TNodePtr const& node ) const -> decltype(std::make_pair(node->get_total_score(), -node->get_g_score())) {
+        return std::make_pair(node->get_total_score(), -node->get_g_score());
+    }
+};
+
+// Frontier for small integer keys (Dial's algorithm).
+// Elements are kept in a circular array of buckets, one per key in [lowest key, lowest key + bucket count),
+// the array grows when the spread of keys does not fit. push is O(1) and pop is amortized O(1)
+// as long as keys do not decrease much, which holds for UCS and A* with a consistent heuristic.
+// Elements with equal keys leave in LIFO order.
+template <typename T, typename FKey = NodeTotalScore>
+class BucketQueue {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+private:
+    FKey key_;
+    std::vector<std::vector<T>> buckets_;
+    size_type size_{0};
+    // lowest and highest key that may be in the queue
+    long long min_key_{0}, max_key_{0};
+
+    std::vector<T>& bucket ( long long key ) { return buckets_[std::size_t(key) & (buckets_.size() - 1)]; }
+    std::vector<T> const& bucket ( long long key ) const { return buckets_[std::size_t(key) & (buckets_.size() - 1)]; }
+
+    void grow ( long long spread ) {
+        std::size_t count = buckets_.size();
+        while (count < std::size_t(spread))
+            count *= 2;
+
+        std::vector<std::vector<T>> old(count);
+        old.swap(buckets_);
+        for (auto& b : old)
+            for (auto& el : b)
+                bucket(key_(el)).push_back(std::move(el));
+    }
+
+public:
+    BucketQueue ( FKey const& key = FKey(), size_type bucket_count = 64 ) : key_(key) {
+        std::size_t count = 1;
+        while (count < bucket_count)
+            count *= 2;
+        buckets_.resize(count);
+    }
+
+    bool empty () const { return size_ == 0; }
+    size_type size () const { return size_; }
+
+    T const& top () const { return bucket(min_key_).back(); }
+
+    void push ( T const& el ) {
+        long long key = key_(el);
+        if (size_ == 0) {
+            min_key_ = max_key_ = key;
+        } else {
+            min_key_ = std::min(min_key_, key);
+            max_key_ = std::max(max_key_, key);
+            if (max_key_ - min_key_ >= static_cast<long long>(buckets_.size()))
+                grow(max_key_ - min_key_ + 1);
+        }
+        bucket(key).push_back(el);
+        ++size_;
+    }
+
+    void pop () {
+        bucket(min_key_).pop_back();
+        if (--size_ == 0)
+            return;
+        while (bucket(min_key_).empty())
+            ++min_key_;
+    }
+};
+
+// Priority frontier that knows where every queued state is, so a queued node can be improved in place.
+// It is a 4-ary min-heap of node pointers ordered by FKey. FStateIndex maps states to dense ids
+// in [0, size()) as for BitmapVisitedSet, and the heap position of every id is kept aside.
+template <typename T, typename FStateIndex, typename FKey = NodeTotalScore>
+class IndexedHeap {
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+private:
+    static constexpr std::size_t arity_ = 4;
+
+#if __cplusplus  > 201402L
+    using key_type = std::invoke_result_t<FKey, T const&>;
+#else
+    using key_type = std::result_of_t<FKey(T const&)>;
+#endif
+
+    struct Entry {
+        key_type key_;
+        T el_;
+    };
+
+    FStateIndex index_;
+    FKey key_;
+    std::vector<Entry> heap_;
+    // heap position + 1 of every state id, 0 when the state is not queued
+    std::vector<std::uint32_t> position_;
+
+    std::size_t id ( T const& el ) const { return index_(el->state_); }
+
+    void place ( std::size_t pos, Entry&& entry ) {
+        position_[id(entry.el_)] = pos + 1;
+        heap_[pos] = std::move(entry);
+    }
+
+    void sift_up ( std::size_t pos ) {
+        Entry entry = std::move(heap_[pos]);
+        while (pos > 0) {
+            std::size_t parent = (pos - 1) / arity_;
+            if (!(entry.key_ < heap_[parent].key_))
+                break;
+            place(pos, std::move(heap_[parent]));
+            pos = parent;
+        }
+        place(pos, std::move(entry));
+    }
+
+    void sift_down ( std::size_t pos ) {
+        Entry entry = std::move(heap_[pos]);
+        for (;;) {
+            std::size_t first = pos * arity_ + 1;
+            if (first >= heap_.size())
+                break;
+
+            std::size_t best = first;
+            std::size_t last = std::min(first + arity_, heap_.size());
+            for (std::size_t child = first + 1; child < last; ++child)
+                if (heap_[child].key_ < heap_[best].key_)
+                    best = child;
+
+            if (!(heap_[best].key_ < entry.key_))
+                break;
+            place(pos, std::move(heap_[best]));
+            pos = best;
+        }
+        place(pos, std::move(entry));
+    }
+
+public:
+    IndexedHeap ( FStateIndex const& index, FKey const& key = FKey() ) : index_(index)
+                                                                       , key_(key)
+                                                                       , position_(index_.size(), 0) {}
+
+    bool empty () const { return heap_.empty(); }
+    size_type size () const { return heap_.size(); }
+
+    T const& top () const { return heap_.front().el_; }
+
+    void push ( T const& el ) {
+        heap_.push_back(Entry{key_(el), el});
+        sift_up(heap_.size() - 1);
+    }
+
+    void pop () {
+        position_[id(heap_.front().el_)] = 0;
+        Entry last = std::move(heap_.back());
+        heap_.pop_back();
+        if (!heap_.empty()) {
+            heap_.front() = std::move(last);
+            sift_down(0);
+        }
+    }
+
+    // Queued element of the state, or a null one
+    template <typename TState>
+    T find ( TState const& state ) const {
+        std::uint32_t pos = position_[index_(state)];
+        return pos == 0 ? T(nullptr) : heap_[pos - 1].el_;
+    }
+
+    // Restores the order after the key of a queued element went down
+    void decrease_key ( T const& el ) {
+        std::size_t pos = position_[id(el)] - 1;
+        heap_[pos].key_ = key_(el);
+        sift_up(pos);
+    }
+};
+
+template <typename TContainer, typename TNodePtr, typename = void>
+struct has_decrease_key : std::false_type {};
+
+template <typename TContainer, typename TNodePtr>
+struct has_decrease_key<TContainer, TNodePtr,
+                        void_t<decltype(std::declval<TContainer&>().decrease_key(std::declval<TNodePtr const&>()))>> : std::true_type {};
+
+// Heuristics may also provide the delta form h(parent_state, parent_h, state),
+// which scores a child from its parent without looking at the whole state
+template <typename FHeuristic, typename TState, typename TScore, typename = void>
+struct has_delta_heuristic : std::false_type {};
+
+template <typename FHeuristic, typename TState, typename TScore>
+struct has_delta_heuristic<FHeuristic, TState, TScore,
+                           void_t<decltype(std::declval<FHeuristic&>()(std::declval<TState const&>(),
+                                                                       std::declval<TScore>(),
+                                                                       std::declval<TState const&>()))>> : std::true_type {};
+
+template <typename FHeuristic, typename TState, typename TScore>
+TScore child_heuristic ( FHeuristic& heuristic, TState const& parent, TScore parent_h, TState const& state, std::true_type ) {
+    return heuristic(parent, parent_h, state);
+}
+
+template <typename FHeuristic, typename TState, typename TScore>
+TScore child_heuristic ( FHeuristic& heuristic, TState const&, TScore, TState const& state, std::false_type ) {
+    return heuristic(state);
+}
+
+template <typename FHeuristic, typename TState, typename TScore>
+TScore child_heuristic ( FHeuristic& heuristic, TState const& parent, TScore parent_h, TState const& state ) {
+    return child_heuristic(heuristic, parent, parent_h, state, has_delta_heuristic<FHeuristic, TState, TScore>{});
+}
+
+// Output iterator that hands every element written through it to a function,
+// so neighbor functors stream their states to the caller without a buffer
+template <typename F>
+struct CallbackIterator {
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = void;
+    using pointer = void;
+    using reference = void;
+
+    F* f_;
+
+    CallbackIterator& operator* () { return *this; }
+    CallbackIterator& operator++ () { return *this; }
+    CallbackIterator& operator++ (int) { return *this; }
+    template <typename T>
+    CallbackIterator& operator= (T const& el) { (*f_)(el); return *this; }
+};
+
+template <typename F>
+CallbackIterator<F> callback_iterator ( F& f ) { return CallbackIterator<F>{&f}; }
 
 template < typename TState,
            typename FGetNeighbors,
            typename FFilter,
            typename TContainer = std::queue<NodePtr<TState>>,
-           typename FHeuristic = DefaultHeuristic<TState, int>>
+           typename FHeuristic = DefaultHeuristic<TState, int>,
+           typename TVisitedSet = DefaultVisitedSet<TState>,
+           template <typename> class TNodeStore = NodeArena>
 class NodeVisitor {
 public:
 
@@ -65,15 +603,33 @@ public:
 #else 
     using TNode = Node<TState, std::result_of_t<FHeuristic(TState)>>;
 #endif
+    using node_store_type = TNodeStore<TNode>;
 
 private:
     FFilter filter_;
     FHeuristic heuristic_;
     TContainer c_{};
     FGetNeighbors get_neighbors_;
-    std::set<TState, std::less<>> visited_;
+    TVisitedSet visited_;
+    node_store_type nodes_;
+
+    bool isVisited (TState const& state) const { return visited_.contains(state); }
 
-    bool isVisited (TState const& state) { return visited_.find(state) != visited_.end(); }
+    // Every move costs the same: a child is one step_cost() below its parent, and
+    // improve() compares paths by that. Weighted moves need a cost from get_neighbors.
+    static typename TNode::score_type step_cost () { return 1; }
+
+    // A visited state may still be queued with a longer path. Frontiers with decrease_key
+    // get the node moved under the current one, the others keep the first path found.
+    void improve (TState const&, TNode const*, std::false_type) {}
+
+    void improve (TState const& state, TNode const* current_node, std::true_type) {
+        TNode* queued = c_.find(state);
+        if (queued != nullptr && current_node->get_g_score() + step_cost() < queued->get_g_score()) {
+            queued->reparent(*current_node, step_cost());
+            c_.decrease_key(queued);
+        }
+    }
 
     template <typename C>
     static
@@ -89,23 +645,78 @@ public:
     NodeVisitor (FFilter const& filter ) : filter_(filter) {};
     NodeVisitor (FFilter const& filter, FHeuristic const& heuristic ) : filter_(filter)
                                                                       , heuristic_(heuristic) {};
+    NodeVisitor (FFilter const& filter, FHeuristic const& heuristic, TVisitedSet const& visited ) : filter_(filter)
+                                                                                                   , heuristic_(heuristic)
+                                                                                                   , visited_(visited) {};
+    NodeVisitor (FFilter const& filter, FHeuristic const& heuristic, TVisitedSet const& visited, TContainer const& c ) : filter_(filter)
+                                                                                                                     , heuristic_(heuristic)
+                                                                                                                     , c_(c)
+                                                                                                                     , visited_(visited) {};
+    // For neighbor functors with state of their own
+    NodeVisitor (FFilter const& filter, FHeuristic const& heuristic, TVisitedSet const& visited, TContainer const& c,
+                 FGetNeighbors const& get_neighbors ) : filter_(filter)
+                                                      , heuristic_(heuristic)
+                                                      , c_(c)
+                                                      , get_neighbors_(get_neighbors)
+                                                      , visited_(visited) {};
+
+    // on_push is called with every node pushed to the frontier
+    // The neighbors go straight from get_neighbors into the frontier, nothing is allocated
+    // here but the nodes themselves.
+    template <typename FOnPush>
+    void visit_neighbors (TNode const* current_node, FOnPush&& on_push) {
+        auto visit = [&](TState const& n) {
+            if (!filter_(n))
+                return;
+            if (!isVisited(n)) {
+                TNode* node = nodes_.emplace(n, *current_node,
+                                             child_heuristic(heuristic_, current_node->state_, current_node->get_h_score(), n),
+                                             step_cost());
+                push(node);
+                on_push(node);
+            } else {
+                improve(n, current_node, has_decrease_key<TContainer, TNode*>{});
+            }
+        };
+        get_neighbors_( current_node->state_, callback_iterator(visit) );
+    };
 
-    void visit_neighbors (std::shared_ptr<TNode> const& current_node) {
-        std::vector<TState> neighbors;
-        get_neighbors_( current_node->state_, std::back_inserter(neighbors) );
+    void visit_neighbors (TNode const* current_node) { visit_neighbors(current_node, [](TNode*) {}); }
 
-        for (auto const& n : neighbors)
-            if (filter_(n) && !isVisited(n)) push(std::make_shared<TNode>(n, current_node, heuristic_(n) ));
-    };
+    // Forgets the last search so the visitor can run another one, the memory is kept for it
+    void clear () {
+        while (!c_.empty())
+            c_.pop();
+        visited_.clear();
+        nodes_.clear();
+    }
+
+    // Same for a search with another heuristic, e.g. towards another goal
+    void clear ( FHeuristic const& heuristic ) {
+        clear();
+        heuristic_ = heuristic;
+    }
 
     bool empty () const { return c_.empty(); } 
+    std::size_t size () const { return c_.size(); }
+
+    // Start the search tree from the given state
+    TNode* push_root ( TState const& state ) {
+        TNode* root = nodes_.emplace(state, heuristic_(state));
+        push(root);
+        return root;
+    }
 
-    void push ( std::shared_ptr<TNode> node ) { 
+    void push ( TNode* node ) { 
         c_.push(node); 
         visited_.insert(node->state_);
     }
 
-    std::shared_ptr<TNode> pop () {
+    TNode* parent ( TNode const* node ) const { return nodes_.parent(*node); }
+
+    TNode* top () const { return pop_impl(c_); }
+
+    TNode* pop () {
         auto tmp = pop_impl(c_);
         c_.pop();
         return tmp; 
@@ -124,11 +735,10 @@ void a_star ( TState const& start, TState const& goal,
               //TExploredNodeIterator explored_node_it = TExploredNodeIterator() ) {
 
     using TNode = typename TNodeVisitor::TNode; //Node<TState>;
-    //using TNodePtr = std::shared_ptr<TNode>;
 
-    node_visitor.push(std::make_shared<TNode> (start));
+    node_visitor.push_root(start);
     
-    std::shared_ptr<TNode> node_it;
+    TNode* node_it = nullptr;
     while ( !node_visitor.empty()) {
         node_it = node_visitor.pop();
 
@@ -145,173 +755,2284 @@ void a_star ( TState const& start, TState const& goal,
     //TODO: process case with no solution
     while (node_it != nullptr) {
         *result_path_it++  = node_it->state_;
-        node_it = node_it->parent_;
+        node_it = node_visitor.parent(node_it);
     }
 }
 
-} // namespace a_star_search
-
-//-------------------------------------------------------------------------
-
-namespace pacman_task {
-using pacman_state_t = std::pair<int, int>;
-bool operator< (pacman_state_t const& lv, pacman_state_t const& rv) {
-    return lv.first < rv.first ? true : lv.second < rv.second;
-}
-pacman_state_t operator+ (pacman_state_t const& lv, pacman_state_t const& rv) {
-    return {lv.first + rv.first, lv.second + rv.second};
-}
-
-using pacman_node_t = a_star_search::NodePtr<pacman_state_t>;
-
+// Node lookup by state for the searches that have to find nodes of another search tree.
+// Hashable states go to a hash map, the others to a tree.
+template <typename TState, typename TNode>
+class NodeMap {
+    typename std::conditional<is_hashable<TState>::value,
+                              std::unordered_map<TState, TNode*, StateHash<TState>>,
+                              std::map<TState, TNode*, std::less<>>>::type nodes_;
 
-// The function returns the neighbors of the given state
-// in a specific order as required by the Hackerrank task.
-struct PacmanNeighborFunctor {
-    template <typename TOutputIterator>
-    void operator() ( pacman_state_t const& current_state, TOutputIterator result) {
-        std::vector< std::pair<int, int> > shifts {
-            {-1,  0}, // UP
-            { 0, -1}, // LEFT
-            { 0,  1}, // RIGHT
-            { 1,  0}  // DOWN
-        };
+public:
+    void insert ( TState const& state, TNode* node ) { nodes_.emplace(state, node); }
 
-        for (auto const& sh : shifts) 
-            *result++ = current_state + sh; 
+    TNode* find ( TState const& state ) const {
+        auto it = nodes_.find(state);
+        return it == nodes_.end() ? nullptr : it->second;
     }
 };
 
-struct PacmanStateFilter {
-    int r_, c_;
-    std::vector<std::string> grid_;
+// Node lookup for bounded state spaces, FStateIndex maps a state to [0, size()) as for BitmapVisitedSet
+template <typename TState, typename TNode, typename FStateIndex>
+class DenseNodeMap {
+    FStateIndex index_;
+    std::vector<TNode*> nodes_;
 
-    bool operator() ( pacman_state_t const& state ) { 
-        if (state.first >= r_|| state.first < 0 || state.second >= c_ || state.second < 0)
-            return false;
-        
-        if ( grid_[state.first][state.second] == '%' )
-            return false;
+public:
+    DenseNodeMap ( FStateIndex const& index ) : index_(index)
+                                              , nodes_(index_.size(), nullptr) {}
 
-        return true;
-    }
+    void insert ( TState const& state, TNode* node ) { nodes_[index_(state)] = node; }
+    TNode* find ( TState const& state ) const { return nodes_[index_(state)]; }
 };
 
-template <typename TQueue>
-void pacman_solve ( int r, int c, std::vector<std::string> const& grid,
-        pacman_state_t const& start, pacman_state_t const& goal,
-        std::vector<pacman_state_t>& result_path, std::vector<pacman_state_t>& explored_nodes ) {
-
-    a_star_search::NodeVisitor <pacman_state_t,
-        PacmanNeighborFunctor, PacmanStateFilter, TQueue> pacman_node_visitor( PacmanStateFilter{r, c, grid} );
-
-    a_star_search::a_star<pacman_state_t> ( 
-            start, goal,
-            pacman_node_visitor,
-            std::back_inserter(result_path),
-            std::back_inserter(explored_nodes)
-          );
+// Writes the path through the meeting state: from the goal to the meeting state
+// along the backward tree, then to the start along the forward tree
+template <typename TNodeVisitor, typename TResultPathIterator>
+void splice_paths ( TNodeVisitor const& forward_visitor, typename TNodeVisitor::TNode const* forward_node,
+                    TNodeVisitor const& backward_visitor, typename TNodeVisitor::TNode const* backward_node,
+                    TResultPathIterator result_path_it ) {
+    using TNode = typename TNodeVisitor::TNode;
+
+    std::vector<TNode const*> to_goal;
+    for (TNode const* n = backward_visitor.parent(backward_node); n != nullptr; n = backward_visitor.parent(n))
+        to_goal.push_back(n);
+
+    for (auto it = to_goal.rbegin(); it != to_goal.rend(); ++it)
+        *result_path_it++ = (*it)->state_;
+    for (TNode const* n = forward_node; n != nullptr; n = forward_visitor.parent(n))
+        *result_path_it++ = n->state_;
 }
 
-template <typename TQueue>
-void pacman_dfs_bfs_solve (int r, int c, std::vector<std::string> const& grid,
-        pacman_state_t const& start, pacman_state_t const& goal) {
+// Breadth first search from both ends for undirected graphs with unit step costs.
+// The visitors must be fresh, with queue containers, the neighbor functor has to be symmetric.
+// Each round expands a whole layer of the smaller frontier and checks every generated state against
+// the other tree; the best meeting found in the first layer that meets is a shortest path.
+// The path is written from goal to start like a_star does.
+template <typename TState,
+          typename TNodeVisitor,
+          typename TResultPathIterator,
+          typename TExploredNodeIterator,
+          typename TNodeMap = NodeMap<TState, typename TNodeVisitor::TNode>>
+bool bidirectional_bfs_search ( TState const& start, TState const& goal,
+                                TNodeVisitor& forward_visitor, TNodeVisitor& backward_visitor,
+                                TResultPathIterator result_path_it,
+                                TExploredNodeIterator explored_node_it,
+                                TNodeMap forward_nodes = TNodeMap(), TNodeMap backward_nodes = TNodeMap() ) {
+    using TNode = typename TNodeVisitor::TNode;
+    using score_t = typename TNode::score_type;
+
+    forward_nodes.insert(start, forward_visitor.push_root(start));
+    backward_nodes.insert(goal, backward_visitor.push_root(goal));
+
+    TNode* forward_meet = nullptr;
+    TNode* backward_meet = nullptr;
+    if (start == goal) {
+        forward_meet = forward_nodes.find(start);
+        backward_meet = backward_nodes.find(goal);
+    }
 
-    std::vector<pacman_state_t> result_path; 
-    std::vector<pacman_state_t> explored_nodes;
-    
-    pacman_solve<TQueue>(r, c, grid, start, goal, result_path, explored_nodes );
+    score_t best = std::numeric_limits<score_t>::max();
+    while (forward_meet == nullptr && !forward_visitor.empty() && !backward_visitor.empty()) {
+        bool forward = forward_visitor.size() <= backward_visitor.size();
+        TNodeVisitor& visitor = forward ? forward_visitor : backward_visitor;
+        auto& own_nodes = forward ? forward_nodes : backward_nodes;
+        auto const& other_nodes = forward ? backward_nodes : forward_nodes;
+
+        TNode* own_meet = nullptr;
+        TNode* other_meet = nullptr;
+        for (auto layer = visitor.size(); layer > 0; --layer) {
+            TNode* node = visitor.pop();
+            *explored_node_it++ = node->state_;
+
+            visitor.visit_neighbors(node, [&](TNode* child) {
+                own_nodes.insert(child->state_, child);
+                TNode* other = other_nodes.find(child->state_);
+                if (other != nullptr && child->get_g_score() + other->get_g_score() < best) {
+                    best = child->get_g_score() + other->get_g_score();
+                    own_meet = child;
+                    other_meet = other;
+                }
+            });
+        }
 
-    // print number of explored nodes
-    std::cout << explored_nodes.size() << std::endl;
-    // print spanning Tree
-    for (const auto& it: explored_nodes)
-        std::cout << it.first << " " << it.second << std::endl;
-    
-    //print path length
-    std::cout << result_path.size()-1 << std::endl;
-    // Print path
-    for ( auto r_it = result_path.rbegin(); r_it != result_path.rend(); ++r_it )
-        std::cout << r_it->first  << " " << r_it->second << std::endl;
-}
+        if (own_meet != nullptr) {
+            forward_meet = forward ? own_meet : other_meet;
+            backward_meet = forward ? other_meet : own_meet;
+        }
+    }
 
-void pacman_dfs_solve ( int r, int c, int pacman_r, int pacman_c, int food_r, int food_c, std::vector <std::string> grid) {
-    
-    pacman_dfs_bfs_solve<std::queue<pacman_node_t>>(r, c, grid, {pacman_r, pacman_c}, {food_r, food_c});
-}
+    if (forward_meet == nullptr)
+        return false;
 
-void pacman_bfs_solve ( int r, int c, int pacman_r, int pacman_c, int food_r, int food_c, std::vector <std::string> grid) {
-    pacman_dfs_bfs_solve<std::stack<pacman_node_t>>(r, c, grid, {pacman_r, pacman_c}, {food_r, food_c});
+    splice_paths(forward_visitor, forward_meet, backward_visitor, backward_meet, result_path_it);
+    return true;
 }
 
+// A* from both ends for undirected graphs. The forward visitor estimates the distance to the goal,
+// the backward one the distance to the start, both heuristics have to be consistent and the frontiers
+// ordered by total score. The best meeting seen is kept until the lowest total score of either
+// frontier reaches its cost: each frontier holds a node of every undiscovered path with a total
+// score not above the path cost, so no shorter path is left. The path is written from goal to start.
+template <typename TState,
+          typename TNodeVisitor,
+          typename TResultPathIterator,
+          typename TExploredNodeIterator,
+          typename TNodeMap = NodeMap<TState, typename TNodeVisitor::TNode>>
+bool bidirectional_astar_search ( TState const& start, TState const& goal,
+                                  TNodeVisitor& forward_visitor, TNodeVisitor& backward_visitor,
+                                  TResultPathIterator result_path_it,
+                                  TExploredNodeIterator explored_node_it,
+                                  TNodeMap forward_nodes = TNodeMap(), TNodeMap backward_nodes = TNodeMap() ) {
+    using TNode = typename TNodeVisitor::TNode;
+    using score_t = typename TNode::score_type;
+
+    forward_nodes.insert(start, forward_visitor.push_root(start));
+    backward_nodes.insert(goal, backward_visitor.push_root(goal));
+
+    score_t best = std::numeric_limits<score_t>::max();
+    TNode* forward_meet = nullptr;
+    TNode* backward_meet = nullptr;
+
+    auto meet = [&](TNode* node, bool forward) {
+        TNode* other = (forward ? backward_nodes : forward_nodes).find(node->state_);
+        if (other != nullptr && node->get_g_score() + other->get_g_score() < best) {
+            best = node->get_g_score() + other->get_g_score();
+            forward_meet = forward ? node : other;
+            backward_meet = forward ? other : node;
+        }
+    };
 
-void pacman_ucs_solve ( int r, int c, int pacman_r, int pacman_c, int food_r, int food_c, std::vector<std::string> const& grid) {
-    std::vector<pacman_state_t> result_path; 
-    std::vector<pacman_state_t> explored_node; 
+    while (!forward_visitor.empty() && !backward_visitor.empty()) {
+        score_t forward_f = forward_visitor.top()->get_total_score();
+        score_t backward_f = backward_visitor.top()->get_total_score();
+        if (std::max(forward_f, backward_f) >= best)
+            break;
 
-    struct UCSHeuristic {
-        int food_r_, food_c_;
-        int operator() (pacman_state_t const& s) { return (s.first == food_r_ && s.second == food_c_) ? 1 : 0; }
-    } ;
+        bool forward = forward_f <= backward_f;
+        TNodeVisitor& visitor = forward ? forward_visitor : backward_visitor;
+        auto& own_nodes = forward ? forward_nodes : backward_nodes;
 
-    struct UCSComparator{
-        bool operator() ( pacman_node_t const l, pacman_node_t const r ) { return l->get_total_score() < r->get_total_score(); }
-    };
+        TNode* node = visitor.pop();
+        *explored_node_it++ = node->state_;
 
-    a_star_search::NodeVisitor<pacman_state_t,
-        PacmanNeighborFunctor, PacmanStateFilter,
-        std::priority_queue<pacman_node_t, std::vector<pacman_node_t>, UCSComparator>,
-        UCSHeuristic> pacman_node_visitor(PacmanStateFilter{r, c, grid}, UCSHeuristic{food_r, food_c});
+        // the node may have got a shorter path after it was generated
+        meet(node, forward);
+        visitor.visit_neighbors(node, [&](TNode* child) {
+            own_nodes.insert(child->state_, child);
+            meet(child, forward);
+        });
+    }
 
-    a_star_search::a_star<pacman_state_t> ( 
-            {pacman_r, pacman_c},
-            {food_r, food_c},
-            pacman_node_visitor,
-            std::back_inserter(result_path),
-            std::back_inserter(explored_node)
-          );
+    if (forward_meet == nullptr)
+        return false;
 
-    //print path length and path
-    std::cout << result_path.size()-1 << std::endl;
-    for ( auto r_it = result_path.rbegin(); r_it != result_path.rend(); ++r_it )
-        std::cout << r_it->first  << " " << r_it->second << std::endl;
+    splice_paths(forward_visitor, forward_meet, backward_visitor, backward_meet, result_path_it);
+    return true;
 }
 
-// Here, we made a small hack by utilizing the fact that the robot's 
-// movement is restricted to left, right, up, and down directions. 
-// Instead of using the Manhattan distance as the g_score, we extended the g_score value at each step
-void pacman_astar_solve ( int r, int c, int pacman_r, int pacman_c, int food_r, int food_c, std::vector<std::string> const& grid) {
-    std::vector<pacman_state_t> result_path; 
-    std::vector<pacman_state_t> explored_node; 
+// Barrier for a fixed group of threads, reusable for every level of a search
+class ThreadBarrier {
+    std::mutex mutex_;
+    std::condition_variable all_arrived_;
+    std::size_t threads_;
+    std::size_t waiting_{0};
+    std::size_t generation_{0};
 
-    struct AStarHeuristic {
+public:
+    explicit ThreadBarrier ( std::size_t threads ) : threads_(threads) {}
+
+    void wait () {
+        std::unique_lock<std::mutex> lock(mutex_);
+        std::size_t generation = generation_;
+        if (++waiting_ == threads_) {
+            waiting_ = 0;
+            ++generation_;
+            all_arrived_.notify_all();
+            return;
+        }
+        all_arrived_.wait(lock, [&]() { return generation != generation_; });
+    }
+};
+
+// Level-synchronous parallel BFS over a bounded state space. The threads take chunks of the
+// current level, claim neighbors in a shared atomic bitmap and collect the next level in buffers
+// of their own. A state is claimed once, the winner records its parent, so paths are shortest
+// but ties between parents are broken by timing. FStateIndex maps states to [0, size()) and
+// back with state(i), the filter is shared by all threads and must be const-callable.
+// Writes the path from goal to start like a_star, returns whether the goal was reached.
+template <typename TState,
+          typename FGetNeighbors,
+          typename FFilter,
+          typename FStateIndex,
+          typename TResultPathIterator>
+bool parallel_bfs ( TState const& start, TState const& goal,
+                    FGetNeighbors const& get_neighbors, FFilter const& filter, FStateIndex const& index,
+                    unsigned threads, TResultPathIterator result_path_it ) {
+    using index_type = std::uint32_t;
+    static constexpr std::size_t chunk = 256;
+
+    if (index.size() >= std::numeric_limits<index_type>::max())
+        throw std::length_error("parallel_bfs: state space is too large");
+    threads = std::max(1u, threads);
+
+    std::vector<std::atomic<std::uint64_t>> claimed((index.size() + 63) / 64);
+    for (auto& word : claimed)
+        word.store(0, std::memory_order_relaxed);
+    auto claim = [&claimed](std::size_t i) {
+        std::uint64_t bit = std::uint64_t(1) << (i & 63);
+        return !(claimed[i >> 6].fetch_or(bit, std::memory_order_relaxed) & bit);
+    };
+
+    std::vector<index_type> parents(index.size());
+    claim(index(start));
+    parents[index(start)] = index(start);
+
+    std::vector<TState> frontier{start};
+    std::vector<std::vector<TState>> next(threads);
+    std::atomic<std::size_t> cursor{0};
+    std::atomic<bool> found{start == goal};
+    // written by thread 0 between the barriers only
+    bool done = found;
+    ThreadBarrier barrier(threads);
+
+    auto work = [&](unsigned t) {
+        FGetNeighbors neighbors_of(get_neighbors);
+        std::vector<TState> neighbors;
+        while (!done) {
+            for (std::size_t begin; (begin = cursor.fetch_add(chunk)) < frontier.size(); ) {
+                for (std::size_t i = begin; i < std::min(begin + chunk, frontier.size()); ++i) {
+                    index_type parent = index(frontier[i]);
+                    neighbors.clear();
+                    neighbors_of(frontier[i], std::back_inserter(neighbors));
+                    for (auto const& n : neighbors) {
+                        if (!filter(n))
+                            continue;
+                        std::size_t j = index(n);
+                        if (claim(j)) {
+                            parents[j] = parent;
+                            next[t].push_back(n);
+                            if (n == goal)
+                                found = true;
+                        }
+                    }
+                }
+            }
+            barrier.wait();
+
+            if (t == 0) {
+                frontier.clear();
+                for (auto& level : next) {
+                    frontier.insert(frontier.end(), level.begin(), level.end());
+                    level.clear();
+                }
+                cursor = 0;
+                done = found || frontier.empty();
+            }
+            barrier.wait();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t)
+        workers.emplace_back(work, t);
+    work(0);
+    for (auto& w : workers)
+        w.join();
+
+    if (!found)
+        return false;
+
+    for (std::size_t i = index(goal); ; i = parents[i]) {
+        *result_path_it++ = index.state(i);
+        if (parents[i] == i)
+            break;
+    }
+    return true;
+}
+
+// Bit-parallel multi-source BFS (MS-BFS, Then et al. 2014). Up to 64 BFS runs share one traversal:
+// every state keeps a mask with a bit per source, and a level hands the masks of its states on to
+// their neighbors, so a state is expanded once per level for all the sources that reached it.
+// Calls visit(i, mask, distance) once per level for each state index i that the sources of `mask`
+// reach for the first time, the sources themselves come first with distance 0. A source that
+// the filter rejects is never indexed and reaches nothing.
+template <typename TState,
+          typename FGetNeighbors,
+          typename FFilter,
+          typename FStateIndex,
+          typename FVisit>
+void multi_source_bfs ( std::vector<TState> const& sources,
+                        FGetNeighbors const& get_neighbors, FFilter const& filter, FStateIndex const& index,
+                        FVisit&& visit ) {
+    if (sources.size() > 64)
+        throw std::invalid_argument("multi_source_bfs: more than 64 sources");
+
+    std::vector<std::uint64_t> seen(index.size(), 0), current(index.size(), 0), next(index.size(), 0);
+    // states of the current and the next level as bitmaps, swept in index order for locality
+    std::vector<std::uint64_t> level((index.size() + 63) / 64, 0), next_level(level.size(), 0);
+    for (std::size_t s = 0; s < sources.size(); ++s) {
+        if (!filter(sources[s]))
+            continue;
+        std::size_t i = index(sources[s]);
+        level[i / 64] |= std::uint64_t(1) << (i % 64);
+        current[i] |= std::uint64_t(1) << s;
+        seen[i] |= std::uint64_t(1) << s;
+    }
+
+    auto sweep = [&](std::vector<std::uint64_t>& bitmap, std::vector<std::uint64_t> const& masks, std::uint32_t distance) {
+        bool any = false;
+        for (std::size_t w = 0; w < bitmap.size(); ++w)
+            for (std::uint64_t bits = bitmap[w]; bits; bits &= bits - 1) {
+                std::size_t i = w * 64 + __builtin_ctzll(bits);
+                visit(i, masks[i], distance);
+                any = true;
+            }
+        return any;
+    };
+
+    FGetNeighbors neighbors_of(get_neighbors);
+    std::vector<TState> neighbors;
+    for (std::uint32_t distance = 1; sweep(level, current, distance - 1); ++distance) {
+        for (std::size_t w = 0; w < level.size(); ++w) {
+            for (std::uint64_t bits = level[w]; bits; bits &= bits - 1) {
+                std::size_t i = w * 64 + __builtin_ctzll(bits);
+                std::uint64_t mask = current[i];
+                current[i] = 0;
+
+                neighbors.clear();
+                neighbors_of(index.state(i), std::back_inserter(neighbors));
+                for (auto const& n : neighbors) {
+                    if (!filter(n))
+                        continue;
+                    std::size_t j = index(n);
+                    std::uint64_t reached = mask & ~seen[j];
+                    if (reached == 0)
+                        continue;
+                    next_level[j / 64] |= std::uint64_t(1) << (j % 64);
+                    next[j] |= reached;
+                    seen[j] |= reached;
+                }
+            }
+            level[w] = 0;
+        }
+        level.swap(next_level);
+        current.swap(next);
+    }
+}
+
+// Work done by each HDA* thread
+struct HdaStarStats {
+    std::vector<std::size_t> expanded_;
+    std::size_t messages_{0};
+};
+
+// Hash-distributed A* (Kishimoto, Fukunaga and Botea, 2009). Every state is owned by the thread
+// its hash maps to, which keeps it in a local open list and a local table of best g scores and
+// parents. Children of other threads are sent to their owner in batches. A state reached again
+// with a lower g is reopened, so the first goal found only gives an incumbent cost; the search
+// ends when all threads are idle, no batch is in flight and no open state has f below the incumbent.
+// Steps cost 1 and the heuristic has to be admissible. Uses the FGetNeighbors, FFilter and
+// FHeuristic functors of NodeVisitor, each thread works with copies of them.
+// Writes the path from goal to start like a_star, returns whether the goal was reached.
+template <typename TState,
+          typename FGetNeighbors,
+          typename FFilter,
+          typename FHeuristic,
+          typename TResultPathIterator>
+bool hda_star ( TState const& start, TState const& goal,
+                FGetNeighbors const& get_neighbors, FFilter const& filter, FHeuristic const& heuristic,
+                unsigned threads, TResultPathIterator result_path_it, HdaStarStats* stats = nullptr ) {
+#if __cplusplus  > 201402L
+    using score_type = std::invoke_result_t<FHeuristic, TState>;
+#else
+    using score_type = std::result_of_t<FHeuristic(TState)>;
+#endif
+    static constexpr std::size_t batch = 64;
+    static constexpr score_type no_cost = std::numeric_limits<score_type>::max();
+
+    struct Message {
+        TState state_;
+        TState parent_;
+        score_type g_;
+    };
+    struct Record {
+        score_type g_;
+        TState parent_;
+    };
+    struct Entry {
+        score_type f_;
+        score_type g_;
+        TState state_;
+        // lowest f first, deeper first among equal f
+        bool operator< ( Entry const& other ) const { return f_ > other.f_ || (f_ == other.f_ && g_ < other.g_); }
+    };
+    struct Inbox {
+        std::mutex mutex_;
+        std::vector<Message> messages_;
+    };
+
+    threads = std::max(1u, threads);
+    StateHash<TState> hash;
+    auto owner = [&hash, threads](TState const& state) {
+        return unsigned(((std::uint64_t(hash(state)) * 0x9E3779B97F4A7C15ull) >> 32) % threads);
+    };
+
+    std::vector<std::unordered_map<TState, Record, StateHash<TState>>> closed(threads);
+    std::vector<std::priority_queue<Entry>> open(threads);
+    std::vector<Inbox> inboxes(threads);
+    std::vector<std::size_t> expanded(threads, 0), sent(threads, 0);
+
+    std::atomic<score_type> incumbent{no_cost};
+    // messages sent and not yet processed by their owner
+    std::atomic<std::size_t> in_flight{0};
+    // bumped whenever a thread gets work again, guards the termination check
+    std::atomic<std::size_t> epoch{0};
+    std::atomic<unsigned> idle{0};
+    std::atomic<bool> done{false};
+
+    {
+        FHeuristic h(heuristic);
+        closed[owner(start)].emplace(start, Record{0, start});
+        open[owner(start)].push(Entry{h(start), 0, start});
+    }
+
+    auto work = [&](unsigned t) {
+        FGetNeighbors neighbors_of(get_neighbors);
+        FFilter accept(filter);
+        FHeuristic h(heuristic);
+        std::vector<std::vector<Message>> outbox(threads);
+        std::vector<Message> received;
+        std::vector<TState> neighbors;
+        bool is_idle = false;
+
+        auto receive = [&](Message const& m) {
+            auto it = closed[t].find(m.state_);
+            if (it != closed[t].end() && it->second.g_ <= m.g_)
+                return;
+            if (it == closed[t].end())
+                closed[t].emplace(m.state_, Record{m.g_, m.parent_});
+            else
+                it->second = Record{m.g_, m.parent_};
+            open[t].push(Entry{m.g_ + h(m.state_), m.g_, m.state_});
+        };
+        auto flush = [&](unsigned to) {
+            if (outbox[to].empty())
+                return;
+            std::lock_guard<std::mutex> lock(inboxes[to].mutex_);
+            in_flight += outbox[to].size();
+            sent[t] += outbox[to].size();
+            inboxes[to].messages_.insert(inboxes[to].messages_.end(), outbox[to].begin(), outbox[to].end());
+            outbox[to].clear();
+        };
+        auto wake = [&]() {
+            if (is_idle) {
+                ++epoch;
+                --idle;
+                is_idle = false;
+            }
+        };
+
+        while (!done) {
+            {
+                std::lock_guard<std::mutex> lock(inboxes[t].mutex_);
+                received.swap(inboxes[t].messages_);
+            }
+            if (!received.empty()) {
+                wake();
+                for (auto const& m : received)
+                    receive(m);
+                in_flight -= received.size();
+                received.clear();
+            }
+
+            // stale entries and entries that cannot beat the incumbent are dropped
+            while (!open[t].empty() && (open[t].top().g_ > closed[t].find(open[t].top().state_)->second.g_
+                                        || open[t].top().f_ >= incumbent))
+                open[t].pop();
+
+            if (!open[t].empty()) {
+                wake();
+                Entry e = open[t].top();
+                open[t].pop();
+
+                if (e.state_ == goal) {
+                    score_type best = incumbent;
+                    while (e.g_ < best && !incumbent.compare_exchange_weak(best, e.g_)) {}
+                    continue;
+                }
+
+                // lets threads that share a core advance together, a thread
+                // running alone for a time slice expands far past the optimal f
+                if (++expanded[t] % batch == 0)
+                    std::this_thread::yield();
+                neighbors.clear();
+                neighbors_of(e.state_, std::back_inserter(neighbors));
+                for (auto const& n : neighbors) {
+                    if (!accept(n))
+                        continue;
+                    unsigned to = owner(n);
+                    if (to == t) {
+                        receive(Message{n, e.state_, e.g_ + 1});
+                    } else {
+                        outbox[to].push_back(Message{n, e.state_, e.g_ + 1});
+                        if (outbox[to].size() >= batch)
+                            flush(to);
+                    }
+                }
+                continue;
+            }
+
+            for (unsigned to = 0; to < threads; ++to)
+                flush(to);
+            if (!is_idle) {
+                is_idle = true;
+                ++idle;
+            }
+
+            std::size_t seen = epoch;
+            if (idle == threads && in_flight == 0 && epoch == seen)
+                done = true;
+            else
+                std::this_thread::yield();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threads; ++t)
+        workers.emplace_back(work, t);
+    work(0);
+    for (auto& w : workers)
+        w.join();
+
+    if (stats) {
+        stats->expanded_ = expanded;
+        stats->messages_ = std::accumulate(sent.begin(), sent.end(), std::size_t(0));
+    }
+    if (incumbent == no_cost)
+        return false;
+
+    for (TState state = goal; ; ) {
+        *result_path_it++ = state;
+        if (state == start)
+            break;
+        state = closed[owner(state)].find(state)->second.parent_;
+    }
+    return true;
+}
+
+// Output iterator that only counts the elements written through it,
+// for callers that do not need the explored nodes themselves
+struct CountingIterator {
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = void;
+    using pointer = void;
+    using reference = void;
+
+    std::size_t* count_;
+
+    CountingIterator& operator* () { return *this; }
+    CountingIterator& operator++ () { return *this; }
+    CountingIterator& operator++ (int) { return *this; }
+    template <typename T>
+    CountingIterator& operator= (T const&) { ++*count_; return *this; }
+};
+
+// Iterative deepening A*. Memory is linear in the solution depth: only the current path is kept
+// and the state is changed in place. The domain provides
+//   moves(state, out)      writes the moves applicable in the state,
+//   apply(state, move)     and undo(state, move) change the state in place,
+//   is_inverse(last, move) tells whether the move undoes the previous one, these are skipped.
+// Moves from start to goal are written to result_moves_it, every expanded state to explored_node_it.
+// A heuristic with the delta form gets a copy of the expanded state as the parent of its children.
+template <typename TState, typename TDomain, typename FHeuristic>
+class IdaStar {
+public:
+    using move_type = typename TDomain::move_type;
+#if __cplusplus  > 201402L
+    using score_type = std::invoke_result_t<FHeuristic, TState>;
+#else
+    using score_type = std::result_of_t<FHeuristic(TState)>;
+#endif
+
+private:
+    static constexpr score_type found_ = std::numeric_limits<score_type>::min();
+    static constexpr score_type none_ = std::numeric_limits<score_type>::max();
+
+    TDomain& domain_;
+    FHeuristic& heuristic_;
+    TState const& goal_;
+    std::vector<move_type> path_;
+    // buffers of the moves on each depth, kept between iterations
+    std::vector<std::vector<move_type>> moves_;
+
+    // Parent of the children being scored, copied only for the delta form of the heuristic
+    struct NoParent {
+        NoParent ( TState const& ) {}
+    };
+    using parent_type = typename std::conditional<has_delta_heuristic<FHeuristic, TState, score_type>::value, TState, NoParent>::type;
+
+    score_type child_h ( TState const& parent, score_type parent_h, TState const& state ) {
+        return child_heuristic(heuristic_, parent, parent_h, state);
+    }
+    score_type child_h ( NoParent const&, score_type, TState const& state ) { return heuristic_(state); }
+
+    // Depth first search under the bound, returns found_ or the smallest total score above the bound
+    template <typename TExploredNodeIterator>
+    score_type search ( TState& state, score_type g, score_type h, score_type bound, TExploredNodeIterator& explored_node_it ) {
+        score_type f = g + h;
+        if (f > bound)
+            return f;
+
+        *explored_node_it++ = state;
+        if (state == goal_)
+            return found_;
+
+        std::size_t depth = path_.size();
+        if (moves_.size() <= depth)
+            moves_.resize(depth + 1);
+        moves_[depth].clear();
+        domain_.moves(state, std::back_inserter(moves_[depth]));
+
+        parent_type const parent(state);
+        score_type next_bound = none_;
+        for (auto const& move : moves_[depth]) {
+            if (depth > 0 && domain_.is_inverse(path_.back(), move))
+                continue;
+
+            domain_.apply(state, move);
+            path_.push_back(move);
+            score_type t = search(state, g + 1, child_h(parent, h, state), bound, explored_node_it);
+            if (t == found_)
+                return found_;
+            path_.pop_back();
+            domain_.undo(state, move);
+            next_bound = std::min(next_bound, t);
+        }
+        return next_bound;
+    }
+
+public:
+    IdaStar ( TDomain& domain, FHeuristic& heuristic, TState const& goal ) : domain_(domain)
+                                                                           , heuristic_(heuristic)
+                                                                           , goal_(goal) {}
+
+    template <typename TResultMovesIterator, typename TExploredNodeIterator>
+    bool operator() ( TState state, TResultMovesIterator result_moves_it, TExploredNodeIterator explored_node_it ) {
+        path_.clear();
+        score_type h = heuristic_(state);
+        for (score_type bound = h; bound != none_; ) {
+            score_type t = search(state, 0, h, bound, explored_node_it);
+            if (t == found_) {
+                std::copy(path_.begin(), path_.end(), result_moves_it);
+                return true;
+            }
+            bound = t;
+        }
+        return false;
+    }
+};
+
+template <typename TState,
+          typename TDomain,
+          typename FHeuristic,
+          typename TResultMovesIterator,
+          typename TExploredNodeIterator>
+bool ida_star ( TState const& start, TState const& goal,
+                TDomain& domain, FHeuristic& heuristic,
+                TResultMovesIterator result_moves_it,
+                TExploredNodeIterator explored_node_it ) {
+    return IdaStar<TState, TDomain, FHeuristic>(domain, heuristic, goal)(start, result_moves_it, explored_node_it);
+}
+
+} // namespace a_star_search
+
+//-------------------------------------------------------------------------
+
+namespace pacman_task {
+using pacman_state_t = std::pair<int, int>;
+// Compact state: the id of a cell in the flat arrays of PacmanPaddedGrid or PacmanLayoutGrid
+using pacman_cell_t = std::uint32_t;
+pacman_state_t operator+ (pacman_state_t const& lv, pacman_state_t const& rv) {
+    return {lv.first + rv.first, lv.second + rv.second};
+}
+
+using pacman_node_t = a_star_search::NodePtr<pacman_state_t>;
+
+// Read-only grid in one contiguous buffer, row i starts i * stride() chars in.
+// Copies share the buffer through a reference count, so filters, visitors and
+// solve functions take the grid by value without copying the cells.
+class GridView {
+    std::shared_ptr<char const> cells_;
+    int r_{0}, c_{0};
+    std::size_t stride_{0};
+
+public:
+    GridView () = default;
+
+    // Copies the rows into a new buffer, short rows are padded with walls
+    GridView ( std::vector<std::string> const& grid ) : r_(int(grid.size())) {
+        for (auto const& row : grid)
+            c_ = std::max(c_, int(row.size()));
+        stride_ = c_;
+
+        char* cells = new char[std::max<std::size_t>(1, r_ * stride_)];
+        cells_.reset(cells, std::default_delete<char const[]>());
+        for (int i = 0; i < r_; ++i) {
+            char* rest = std::copy(grid[i].begin(), grid[i].end(), cells + i * stride_);
+            std::fill(rest, cells + (i + 1) * stride_, '%');
+        }
+    }
+
+    // Shares a buffer laid out with the given row stride
+    GridView ( std::shared_ptr<char const> cells, int r, int c, std::size_t stride ) : cells_(std::move(cells))
+                                                                                   , r_(r)
+                                                                                   , c_(c)
+                                                                                   , stride_(stride) {}
+
+    int rows () const { return r_; }
+    int cols () const { return c_; }
+    std::size_t stride () const { return stride_; }
+
+    char const* operator[] ( int i ) const { return cells_.get() + i * stride_; }
+
+    // A copy of the grid with one cell changed, this view and its other copies keep the old cells
+    GridView with_cell ( pacman_state_t const& cell, char value ) const {
+        char* cells = new char[std::max<std::size_t>(1, r_ * stride_)];
+        GridView grid(std::shared_ptr<char const>(cells, std::default_delete<char const[]>()), r_, c_, stride_);
+        std::copy(cells_.get(), cells_.get() + r_ * stride_, cells);
+        cells[cell.first * stride_ + cell.second] = value;
+        return grid;
+    }
+};
+
+
+// The function returns the neighbors of the given state
+// in a specific order as required by the Hackerrank task.
+struct PacmanNeighborFunctor {
+    static constexpr pacman_state_t shifts[] = {
+        {-1,  0}, // UP
+        { 0, -1}, // LEFT
+        { 0,  1}, // RIGHT
+        { 1,  0}  // DOWN
+    };
+
+    template <typename TOutputIterator>
+    void operator() ( pacman_state_t const& current_state, TOutputIterator result) const {
+        for (auto const& sh : shifts) 
+            *result++ = current_state + sh; 
+    }
+};
+constexpr pacman_state_t PacmanNeighborFunctor::shifts[];
+
+struct PacmanStateFilter {
+    int r_, c_;
+    GridView grid_;
+
+    PacmanStateFilter () = default;
+    // r and c as read from the input are clipped to the view, so cells past its rows are never read
+    PacmanStateFilter ( int r, int c, GridView grid ) : r_(std::min(r, grid.rows()))
+                                                      , c_(std::min(c, grid.cols()))
+                                                      , grid_(std::move(grid)) {}
+
+    bool operator() ( pacman_state_t const& state ) const { 
+        if (state.first >= r_|| state.first < 0 || state.second >= c_ || state.second < 0)
+            return false;
+        
+        if ( grid_[state.first][state.second] == '%' )
+            return false;
+
+        return true;
+    }
+};
+
+// Position of a cell in the row-major r x c grid, lets visited sets be dense bitmaps
+struct PacmanCellIndex {
+    int r_, c_;
+
+    std::size_t operator() ( pacman_state_t const& state ) const { return std::size_t(state.first) * c_ + state.second; }
+    pacman_state_t state ( std::size_t i ) const { return {int(i / c_), int(i % c_)}; }
+    std::size_t size () const { return std::size_t(r_) * c_; }
+    bool contains ( pacman_state_t const& state ) const {
+        return state.first >= 0 && state.first < r_ && state.second >= 0 && state.second < c_;
+    }
+};
+
+using pacman_visited_t = a_star_search::BitmapVisitedSet<pacman_state_t, PacmanCellIndex>;
+// A* frontier that lets queued cells get a shorter path
+using pacman_frontier_t = a_star_search::IndexedHeap<pacman_node_t, PacmanCellIndex, a_star_search::NodeScoreDeepestFirst>;
+
+// Frontiers indexed by cell are built for the grid, the others are default constructed
+template <typename TQueue>
+TQueue make_pacman_queue ( int r, int c, std::true_type ) { return TQueue(PacmanCellIndex{r, c}); }
+
+template <typename TQueue>
+TQueue make_pacman_queue ( int, int, std::false_type ) { return TQueue(); }
+
+template <typename TQueue, typename FStateIndex>
+TQueue make_pacman_queue ( FStateIndex const& index, std::true_type ) { return TQueue(index); }
+
+template <typename TQueue, typename FStateIndex>
+TQueue make_pacman_queue ( FStateIndex const&, std::false_type ) { return TQueue(); }
+
+template <typename TQueue, typename FHeuristic = a_star_search::DefaultHeuristic<pacman_state_t>>
+void pacman_solve ( int r, int c, GridView const& grid,
+        pacman_state_t const& start, pacman_state_t const& goal,
+        std::vector<pacman_state_t>& result_path, std::vector<pacman_state_t>& explored_nodes,
+        FHeuristic const& heuristic = FHeuristic{} ) {
+
+    // the root is not filtered and the bitmaps are indexed by cell, a start off the grid finds nothing
+    if (!PacmanCellIndex{r, c}.contains(start))
+        return;
+
+    a_star_search::NodeVisitor <pacman_state_t,
+        PacmanNeighborFunctor, PacmanStateFilter, TQueue,
+        FHeuristic, pacman_visited_t> pacman_node_visitor( PacmanStateFilter{r, c, grid}, heuristic,
+                                                           pacman_visited_t{PacmanCellIndex{r, c}},
+                                                           make_pacman_queue<TQueue>(r, c, std::is_constructible<TQueue, PacmanCellIndex>{}) );
+
+    a_star_search::a_star<pacman_state_t> ( 
+            start, goal,
+            pacman_node_visitor,
+            std::back_inserter(result_path),
+            std::back_inserter(explored_nodes)
+          );
+}
+
+// Grid with a one-cell border of walls, stored as one flat array of free flags. States are
+// linear indices into it, so the neighbors of a cell are cell - stride, cell - 1, cell + 1 and
+// cell + stride, and a single load tells whether one is free: no range checks are needed.
+class PacmanPaddedGrid {
+public:
+    using cell_type = pacman_cell_t;
+
+private:
+    int r_, c_;
+    std::size_t stride_;
+    std::vector<std::uint8_t> free_;
+
+public:
+    explicit PacmanPaddedGrid ( PacmanStateFilter const& filter ) : r_(filter.r_)
+                                                                 , c_(filter.c_)
+                                                                 , stride_(filter.c_ + 2)
+                                                                 , free_(std::size_t(filter.r_ + 2) * stride_, 0) {
+        if (free_.size() > std::numeric_limits<cell_type>::max())
+            throw std::length_error("PacmanPaddedGrid: grid is too large");
+        for (int i = 0; i < r_; ++i)
+            for (int j = 0; j < c_; ++j)
+                free_[cell({i, j})] = filter({i, j});
+    }
+
+    std::size_t stride () const { return stride_; }
+    std::size_t size () const { return free_.size(); }
+    std::uint8_t const* data () const { return free_.data(); }
+
+    // Only cells of the grid have ids, cell() does not check
+    bool contains ( pacman_state_t const& state ) const {
+        return state.first >= 0 && state.first < r_ && state.second >= 0 && state.second < c_;
+    }
+
+    cell_type cell ( pacman_state_t const& state ) const { return cell_type((state.first + 1) * stride_ + state.second + 1); }
+    pacman_state_t state ( cell_type cell ) const { return {int(cell / stride_) - 1, int(cell % stride_) - 1}; }
+};
+
+// Neighbors of a padded grid cell in the UP, LEFT, RIGHT, DOWN order of PacmanNeighborFunctor
+struct PacmanPaddedNeighborFunctor {
+    std::ptrdiff_t stride_;
+
+    template <typename TOutputIterator>
+    void operator() ( PacmanPaddedGrid::cell_type cell, TOutputIterator result ) const {
+        *result++ = PacmanPaddedGrid::cell_type(cell - stride_);
+        *result++ = cell - 1;
+        *result++ = cell + 1;
+        *result++ = PacmanPaddedGrid::cell_type(cell + stride_);
+    }
+};
+
+// The border cells are walls, so every neighbor of an inner cell can be looked up as it is
+struct PacmanPaddedFilter {
+    std::uint8_t const* free_;
+
+    bool operator() ( PacmanPaddedGrid::cell_type cell ) const { return free_[cell]; }
+};
+
+// Cells are their own dense index, for BitmapVisitedSet and IndexedHeap
+struct PacmanPaddedIndex {
+    std::size_t size_;
+
+    std::size_t operator() ( PacmanPaddedGrid::cell_type cell ) const { return cell; }
+    PacmanPaddedGrid::cell_type state ( std::size_t i ) const { return PacmanPaddedGrid::cell_type(i); }
+    std::size_t size () const { return size_; }
+};
+
+using pacman_padded_node_t = a_star_search::NodePtr<PacmanPaddedGrid::cell_type>;
+using pacman_padded_frontier_t = a_star_search::IndexedHeap<pacman_padded_node_t, PacmanPaddedIndex, a_star_search::NodeScoreDeepestFirst>;
+
+// ManhattanHeuristic on padded grid cells
+struct PacmanPaddedManhattan {
+    std::uint32_t stride_, goal_row_, goal_col_;
+
+    PacmanPaddedManhattan ( PacmanPaddedGrid const& grid, PacmanPaddedGrid::cell_type goal ) : stride_(grid.stride())
+                                                                                            , goal_row_(goal / stride_)
+                                                                                            , goal_col_(goal % stride_) {}
+
+    int operator() ( PacmanPaddedGrid::cell_type cell ) const {
+        int row = cell / stride_, col = cell % stride_;
+        return std::abs(row - int(goal_row_)) + std::abs(col - int(goal_col_));
+    }
+};
+
+// pacman_solve on the padded grid, the path and the explored cells are the same
+template <typename TQueue, typename FHeuristic = a_star_search::DefaultHeuristic<PacmanPaddedGrid::cell_type>>
+void pacman_padded_solve ( PacmanPaddedGrid const& grid,
+        pacman_state_t const& start, pacman_state_t const& goal,
+        std::vector<pacman_state_t>& result_path, std::vector<pacman_state_t>& explored_nodes,
+        FHeuristic const& heuristic = FHeuristic{} ) {
+
+    if (!grid.contains(start))
+        return;
+
+    using cell_t = PacmanPaddedGrid::cell_type;
+    using visited_t = a_star_search::BitmapVisitedSet<cell_t, PacmanPaddedIndex>;
+    PacmanPaddedIndex index{grid.size()};
+
+    a_star_search::NodeVisitor <cell_t,
+        PacmanPaddedNeighborFunctor, PacmanPaddedFilter, TQueue,
+        FHeuristic, visited_t> node_visitor( PacmanPaddedFilter{grid.data()}, heuristic, visited_t{index},
+                                             make_pacman_queue<TQueue>(index, std::is_constructible<TQueue, PacmanPaddedIndex>{}),
+                                             PacmanPaddedNeighborFunctor{std::ptrdiff_t(grid.stride())} );
+
+    // a goal off the grid is never reached, like in pacman_solve: give it an id no cell has
+    std::vector<cell_t> path, explored;
+    a_star_search::a_star<cell_t> ( 
+            grid.cell(start), grid.contains(goal) ? grid.cell(goal) : cell_t(grid.size()),
+            node_visitor,
+            std::back_inserter(path),
+            std::back_inserter(explored)
+          );
+
+    for (cell_t cell : path)
+        result_path.push_back(grid.state(cell));
+    for (cell_t cell : explored)
+        explored_nodes.push_back(grid.state(cell));
+}
+
+// Cell ids of a grid with a one-cell border of walls in row-major order, the order of PacmanPaddedGrid
+class PacmanRowMajorLayout {
+    std::size_t stride_, size_;
+
+public:
+    PacmanRowMajorLayout ( int r, int c ) : stride_(std::size_t(c) + 2), size_((std::size_t(r) + 2) * stride_) {
+        if (size_ > std::numeric_limits<pacman_cell_t>::max())
+            throw std::length_error("PacmanRowMajorLayout: grid is too large");
+    }
+
+    std::size_t size () const { return size_; }
+
+    pacman_cell_t cell ( pacman_state_t const& state ) const { return pacman_cell_t((state.first + 1) * stride_ + state.second + 1); }
+    pacman_state_t state ( pacman_cell_t cell ) const { return {int(cell / stride_) - 1, int(cell % stride_) - 1}; }
+
+    pacman_cell_t up ( pacman_cell_t cell ) const { return pacman_cell_t(cell - stride_); }
+    pacman_cell_t left ( pacman_cell_t cell ) const { return cell - 1; }
+    pacman_cell_t right ( pacman_cell_t cell ) const { return cell + 1; }
+    pacman_cell_t down ( pacman_cell_t cell ) const { return pacman_cell_t(cell + stride_); }
+};
+
+// Cell ids of a grid with a one-cell border of walls in Z-order: the bits of row + 1 and col + 1
+// are interleaved, so cells close to each other in any direction are mostly close in memory too.
+// When one side needs more bits than the other, its high bits go on top uninterleaved. A neighbor
+// is one step of dilated arithmetic: the bits of the other coordinate are filled with ones, so a
+// carry or a borrow passes over them.
+class PacmanMortonLayout {
+    pacman_cell_t row_mask_ = 0, col_mask_ = 0;
+    std::vector<pacman_cell_t> row_bits_, col_bits_;
+
+    static pacman_cell_t deposit ( std::uint64_t value, pacman_cell_t mask ) {
+        pacman_cell_t result = 0;
+        for (pacman_cell_t bit = 1; mask != 0 && value != 0; bit <<= 1) {
+            if (mask & bit) {
+                if (value & 1)
+                    result |= bit;
+                value >>= 1;
+                mask &= ~bit;
+            }
+        }
+        return result;
+    }
+
+    static int extract ( pacman_cell_t cell, pacman_cell_t mask ) {
+        int result = 0;
+        for (int shift = 0; mask != 0; mask &= mask - 1, ++shift)
+            result |= int((cell >> __builtin_ctz(mask)) & 1) << shift;
+        return result;
+    }
+
+    // (row, col) parts of each byte of a cell id, byte b of the id at decode_[b * 256 + value]
+    std::vector<pacman_state_t> decode_;
+
+    static int bits ( int max_value ) {
+        int n = 0;
+        while ((max_value >> n) != 0)
+            ++n;
+        return n;
+    }
+
+public:
+    PacmanMortonLayout ( int r, int c ) {
+        int row_bits = bits(r + 1), col_bits = bits(c + 1);
+        if (row_bits + col_bits > 31)
+            throw std::length_error("PacmanMortonLayout: grid is too large");
+
+        pacman_cell_t bit = 1;
+        for (int k = 0; k < std::max(row_bits, col_bits); ++k) {
+            if (k < col_bits) {
+                col_mask_ |= bit;
+                bit <<= 1;
+            }
+            if (k < row_bits) {
+                row_mask_ |= bit;
+                bit <<= 1;
+            }
+        }
+
+        row_bits_.resize(std::size_t(r) + 2);
+        col_bits_.resize(std::size_t(c) + 2);
+        for (std::size_t i = 0; i < row_bits_.size(); ++i)
+            row_bits_[i] = deposit(i, row_mask_);
+        for (std::size_t j = 0; j < col_bits_.size(); ++j)
+            col_bits_[j] = deposit(j, col_mask_);
+
+        decode_.resize(4 * 256);
+        for (pacman_cell_t i = 0; i < decode_.size(); ++i) {
+            pacman_cell_t cell = (i % 256) << (i / 256 * 8);
+            decode_[i] = {extract(cell, row_mask_), extract(cell, col_mask_)};
+        }
+    }
+
+    std::size_t size () const { return std::size_t(row_bits_.back() | col_bits_.back()) + 1; }
+
+    pacman_cell_t cell ( pacman_state_t const& state ) const { return row_bits_[state.first + 1] | col_bits_[state.second + 1]; }
+    pacman_state_t state ( pacman_cell_t cell ) const {
+        pacman_state_t const& b0 = decode_[cell & 0xff];
+        pacman_state_t const& b1 = decode_[256 + (cell >> 8 & 0xff)];
+        pacman_state_t const& b2 = decode_[512 + (cell >> 16 & 0xff)];
+        pacman_state_t const& b3 = decode_[768 + (cell >> 24)];
+        return {b0.first + b1.first + b2.first + b3.first - 1, b0.second + b1.second + b2.second + b3.second - 1};
+    }
+
+    pacman_cell_t up ( pacman_cell_t cell ) const { return (((cell & row_mask_) - 1) & row_mask_) | (cell & col_mask_); }
+    pacman_cell_t left ( pacman_cell_t cell ) const { return (((cell & col_mask_) - 1) & col_mask_) | (cell & row_mask_); }
+    pacman_cell_t right ( pacman_cell_t cell ) const { return (((cell | row_mask_) + 1) & col_mask_) | (cell & row_mask_); }
+    pacman_cell_t down ( pacman_cell_t cell ) const { return (((cell | col_mask_) + 1) & row_mask_) | (cell & col_mask_); }
+};
+
+// Free flags of a grid stored in the order of TLayout, with a one-cell border of walls.
+// Per-cell side arrays (visited, parent, distance) indexed by cell id follow the same order.
+template <typename TLayout>
+class PacmanLayoutGrid {
+    int r_, c_;
+    TLayout layout_;
+    std::vector<std::uint8_t> free_;
+
+public:
+    explicit PacmanLayoutGrid ( PacmanStateFilter const& filter ) : r_(filter.r_)
+                                                                 , c_(filter.c_)
+                                                                 , layout_(filter.r_, filter.c_)
+                                                                 , free_(layout_.size(), 0) {
+        for (int i = 0; i < filter.r_; ++i)
+            for (int j = 0; j < filter.c_; ++j)
+                free_[layout_.cell({i, j})] = filter({i, j});
+    }
+
+    TLayout const& layout () const { return layout_; }
+    std::size_t size () const { return free_.size(); }
+    std::uint8_t const* data () const { return free_.data(); }
+
+    // Only cells of the grid have ids, cell() does not check
+    bool contains ( pacman_state_t const& state ) const {
+        return state.first >= 0 && state.first < r_ && state.second >= 0 && state.second < c_;
+    }
+
+    pacman_cell_t cell ( pacman_state_t const& state ) const { return layout_.cell(state); }
+    pacman_state_t state ( pacman_cell_t cell ) const { return layout_.state(cell); }
+};
+
+// Neighbors of a layout grid cell in the UP, LEFT, RIGHT, DOWN order of PacmanNeighborFunctor
+template <typename TLayout>
+struct PacmanLayoutNeighborFunctor {
+    TLayout const* layout_;
+
+    template <typename TOutputIterator>
+    void operator() ( pacman_cell_t cell, TOutputIterator result ) const {
+        *result++ = layout_->up(cell);
+        *result++ = layout_->left(cell);
+        *result++ = layout_->right(cell);
+        *result++ = layout_->down(cell);
+    }
+};
+
+// ManhattanHeuristic on layout grid cells
+template <typename TLayout>
+struct PacmanLayoutManhattan {
+    TLayout const* layout_;
+    pacman_state_t goal_;
+
+    int operator() ( pacman_cell_t cell ) const {
+        pacman_state_t state = layout_->state(cell);
+        return std::abs(state.first - goal_.first) + std::abs(state.second - goal_.second);
+    }
+};
+
+// pacman_solve on a layout grid, the path and the explored cells are the same
+template <typename TQueue, typename TLayout, typename FHeuristic = a_star_search::DefaultHeuristic<pacman_cell_t>>
+void pacman_layout_solve ( PacmanLayoutGrid<TLayout> const& grid,
+        pacman_state_t const& start, pacman_state_t const& goal,
+        std::vector<pacman_state_t>& result_path, std::vector<pacman_state_t>& explored_nodes,
+        FHeuristic const& heuristic = FHeuristic{} ) {
+
+    if (!grid.contains(start))
+        return;
+
+    using visited_t = a_star_search::BitmapVisitedSet<pacman_cell_t, PacmanPaddedIndex>;
+    PacmanPaddedIndex index{grid.size()};
+
+    a_star_search::NodeVisitor <pacman_cell_t,
+        PacmanLayoutNeighborFunctor<TLayout>, PacmanPaddedFilter, TQueue,
+        FHeuristic, visited_t> node_visitor( PacmanPaddedFilter{grid.data()}, heuristic, visited_t{index},
+                                             make_pacman_queue<TQueue>(index, std::is_constructible<TQueue, PacmanPaddedIndex>{}),
+                                             PacmanLayoutNeighborFunctor<TLayout>{&grid.layout()} );
+
+    // a goal off the grid is never reached, like in pacman_solve: give it an id no cell has
+    std::vector<pacman_cell_t> path, explored;
+    a_star_search::a_star<pacman_cell_t> ( 
+            grid.cell(start), grid.contains(goal) ? grid.cell(goal) : pacman_cell_t(grid.size()),
+            node_visitor,
+            std::back_inserter(path),
+            std::back_inserter(explored)
+          );
+
+    for (pacman_cell_t cell : path)
+        result_path.push_back(grid.state(cell));
+    for (pacman_cell_t cell : explored)
+        explored_nodes.push_back(grid.state(cell));
+}
+
+// Breadth-first distances from source with the per-cell side arrays in the order of the layout:
+// distances[cell] is unreachable for cells that were not reached, parents[cell] is the cell it was
+// reached from, or the cell itself for the source and the cells that were not reached.
+// Returns the number of cells reached.
+template <typename TLayout>
+std::size_t pacman_layout_bfs ( PacmanLayoutGrid<TLayout> const& grid, pacman_state_t const& source,
+                                std::vector<std::uint32_t>& distances, std::vector<pacman_cell_t>& parents ) {
+    static constexpr std::uint32_t unreachable = std::numeric_limits<std::uint32_t>::max();
+
+    distances.assign(grid.size(), unreachable);
+    parents.resize(grid.size());
+    std::iota(parents.begin(), parents.end(), pacman_cell_t(0));
+
+    if (!grid.contains(source) || !grid.data()[grid.cell(source)])
+        return 0;
+    pacman_cell_t const start = grid.cell(source);
+
+    std::vector<pacman_cell_t> queue;
+    queue.reserve(grid.size());
+    queue.push_back(start);
+    distances[start] = 0;
+
+    std::uint8_t const* free = grid.data();
+    PacmanLayoutNeighborFunctor<TLayout> get_neighbors{&grid.layout()};
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        pacman_cell_t const cell = queue[head];
+        std::uint32_t const d = distances[cell] + 1;
+        auto visit = [&](pacman_cell_t neighbor) {
+            if (free[neighbor] && distances[neighbor] == unreachable) {
+                distances[neighbor] = d;
+                parents[neighbor] = cell;
+                queue.push_back(neighbor);
+            }
+        };
+        get_neighbors(cell, a_star_search::callback_iterator(visit));
+    }
+    return queue.size();
+}
+
+template <typename TQueue, typename FHeuristic = a_star_search::DefaultHeuristic<pacman_state_t>>
+using pacman_visitor_t = a_star_search::NodeVisitor<pacman_state_t,
+    PacmanNeighborFunctor, PacmanStateFilter, TQueue, FHeuristic, pacman_visited_t>;
+
+template <typename TVisitor>
+using pacman_node_map_t = a_star_search::DenseNodeMap<pacman_state_t, typename TVisitor::TNode, PacmanCellIndex>;
+
+// Breadth first search from pacman and from the food at once
+bool pacman_bidirectional_bfs_search ( int r, int c, GridView const& grid,
+        pacman_state_t const& start, pacman_state_t const& goal,
+        std::vector<pacman_state_t>& result_path, std::vector<pacman_state_t>& explored_nodes ) {
+
+    // both ends seed a search tree unfiltered, and the bitmaps are indexed by cell
+    PacmanStateFilter filter{r, c, grid};
+    if (!filter(start) || !filter(goal))
+        return false;
+
+    using visitor_t = pacman_visitor_t<std::queue<pacman_node_t>>;
+    visitor_t forward_visitor(filter, {}, pacman_visited_t{PacmanCellIndex{r, c}});
+    visitor_t backward_visitor(filter, {}, pacman_visited_t{PacmanCellIndex{r, c}});
+
+    return a_star_search::bidirectional_bfs_search<pacman_state_t> (
+            start, goal,
+            forward_visitor, backward_visitor,
+            std::back_inserter(result_path),
+            std::back_inserter(explored_nodes),
+            pacman_node_map_t<visitor_t>{PacmanCellIndex{r, c}},
+            pacman_node_map_t<visitor_t>{PacmanCellIndex{r, c}}
+          );
+}
+
+// A* from pacman and from the food at once, each side estimates the distance to the other end
+bool pacman_bidirectional_astar_search ( int r, int c, GridView const& grid,
+        pacman_state_t const& start, pacman_state_t const& goal,
+        std::vector<pacman_state_t>& result_path, std::vector<pacman_state_t>& explored_nodes ) {
+
+    // both ends seed a search tree unfiltered, and the bitmaps are indexed by cell
+    PacmanStateFilter filter{r, c, grid};
+    if (!filter(start) || !filter(goal))
+        return false;
+
+    using heuristic_t = a_star_search::ManhattanHeuristic<pacman_state_t>;
+    using visitor_t = pacman_visitor_t<pacman_frontier_t, heuristic_t>;
+    visitor_t forward_visitor(filter, heuristic_t{goal},
+                              pacman_visited_t{PacmanCellIndex{r, c}}, pacman_frontier_t{PacmanCellIndex{r, c}});
+    visitor_t backward_visitor(filter, heuristic_t{start},
+                               pacman_visited_t{PacmanCellIndex{r, c}}, pacman_frontier_t{PacmanCellIndex{r, c}});
+
+    return a_star_search::bidirectional_astar_search<pacman_state_t> (
+            start, goal,
+            forward_visitor, backward_visitor,
+            std::back_inserter(result_path),
+            std::back_inserter(explored_nodes),
+            pacman_node_map_t<visitor_t>{PacmanCellIndex{r, c}},
+            pacman_node_map_t<visitor_t>{PacmanCellIndex{r, c}}
+          );
+}
+
+template <typename TQueue>
+void pacman_dfs_bfs_solve (int r, int c, GridView const& grid,
+        pacman_state_t const& start, pacman_state_t const& goal) {
+
+    std::vector<pacman_state_t> result_path; 
+    std::vector<pacman_state_t> explored_nodes;
+    
+    pacman_solve<TQueue>(r, c, grid, start, goal, result_path, explored_nodes );
+
+    // print number of explored nodes
+    std::cout << explored_nodes.size() << std::endl;
+    // print spanning Tree
+    for (const auto& it: explored_nodes)
+        std::cout << it.first << " " << it.second << std::endl;
+    
+    //print path length
+    std::cout << result_path.size()-1 << std::endl;
+    // Print path
+    for ( auto r_it = result_path.rbegin(); r_it != result_path.rend(); ++r_it )
+        std::cout << r_it->first  << " " << r_it->second << std::endl;
+}
+
+void pacman_dfs_solve ( int r, int c, int pacman_r, int pacman_c, int food_r, int food_c, GridView const& grid) {
+    
+    pacman_dfs_bfs_solve<std::queue<pacman_node_t>>(r, c, grid, {pacman_r, pacman_c}, {food_r, food_c});
+}
+
+void pacman_bfs_solve ( int r, int c, int pacman_r, int pacman_c, int food_r, int food_c, GridView const& grid) {
+    pacman_dfs_bfs_solve<std::stack<pacman_node_t>>(r, c, grid, {pacman_r, pacman_c}, {food_r, food_c});
+}
+
+
+void pacman_ucs_solve ( int r, int c, int pacman_r, int pacman_c, int food_r, int food_c, GridView const& grid) {
+    std::vector<pacman_state_t> result_path; 
+    std::vector<pacman_state_t> explored_node; 
+
+    struct UCSHeuristic {
         int food_r_, food_c_;
         int operator() (pacman_state_t const& s) { return (s.first == food_r_ && s.second == food_c_) ? 1 : 0; }
-    };
+    } ;
+
+    a_star_search::NodeVisitor<pacman_state_t,
+        PacmanNeighborFunctor, PacmanStateFilter,
+        a_star_search::BucketQueue<pacman_node_t>,
+        UCSHeuristic, pacman_visited_t> pacman_node_visitor(PacmanStateFilter{r, c, grid}, UCSHeuristic{food_r, food_c},
+                                                            pacman_visited_t{PacmanCellIndex{r, c}});
+
+    a_star_search::a_star<pacman_state_t> ( 
+            {pacman_r, pacman_c},
+            {food_r, food_c},
+            pacman_node_visitor,
+            std::back_inserter(result_path),
+            std::back_inserter(explored_node)
+          );
+
+    //print path length and path
+    std::cout << result_path.size()-1 << std::endl;
+    for ( auto r_it = result_path.rbegin(); r_it != result_path.rend(); ++r_it )
+        std::cout << r_it->first  << " " << r_it->second << std::endl;
+}
+
+// Moves are restricted to up, down, left and right, so the Manhattan distance to the food
+// is an admissible and consistent heuristic
+void pacman_astar_solve ( int r, int c, int pacman_r, int pacman_c, int food_r, int food_c, GridView const& grid) {
+    std::vector<pacman_state_t> result_path; 
+    std::vector<pacman_state_t> explored_node; 
+
+    pacman_solve<pacman_frontier_t>(r, c, grid, {pacman_r, pacman_c}, {food_r, food_c}, result_path, explored_node,
+                                    a_star_search::ManhattanHeuristic<pacman_state_t>{{food_r, food_c}});
+
+    //print path length and path
+    std::cout << result_path.size()-1 << std::endl;
+    for ( auto r_it = result_path.rbegin(); r_it != result_path.rend(); ++r_it )
+        std::cout << r_it->first  << " " << r_it->second << std::endl;
+}
+
+// Jump Point Search for 4-connected grids with unit step costs.
+// Among the shortest paths it keeps the ones that move vertically before they move horizontally,
+// and turns from a horizontal to a vertical move only where a wall forces it: moving horizontally
+// into a cell, the cell above (below) it is a forced neighbor when the cell above (below) the previous
+// one is a wall. Vertical moves may always continue in the three non-reversing directions.
+// Runs of cells without forced neighbors are jumped over, so A* only sees jump points:
+// the goal, cells with forced neighbors and cells on vertical runs whose horizontal scans hit one of those.
+class PacmanJumpPointSearch {
+    PacmanStateFilter const& filter_;
+    pacman_state_t goal_;
+
+    bool free ( int r, int c ) const { return filter_({r, c}); }
+
+    // The next jump point from `from` in horizontal direction dc, returns false on a dead end
+    bool jump_horizontal ( pacman_state_t from, int dc, pacman_state_t& jump_point ) const {
+        for (pacman_state_t cell{from.first, from.second + dc}; free(cell.first, cell.second); cell.second += dc) {
+            if (cell == goal_ ||
+                (free(cell.first - 1, cell.second) && !free(cell.first - 1, cell.second - dc)) ||
+                (free(cell.first + 1, cell.second) && !free(cell.first + 1, cell.second - dc))) {
+                jump_point = cell;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // The next jump point from `from` in vertical direction dr, returns false on a dead end
+    bool jump_vertical ( pacman_state_t from, int dr, pacman_state_t& jump_point ) const {
+        pacman_state_t ignored;
+        for (pacman_state_t cell{from.first + dr, from.second}; free(cell.first, cell.second); cell.first += dr) {
+            if (cell == goal_ || jump_horizontal(cell, -1, ignored) || jump_horizontal(cell, 1, ignored)) {
+                jump_point = cell;
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    PacmanJumpPointSearch ( PacmanStateFilter const& filter, pacman_state_t const& goal ) : filter_(filter)
+                                                                                          , goal_(goal) {}
+
+    // Jump points reachable from `cell` entered from `parent`, the root has no parent
+    template <typename TOutputIterator>
+    void successors ( pacman_state_t const& cell, pacman_state_t const* parent, TOutputIterator result ) const {
+        int dr = parent == nullptr ? 0 : (cell.first > parent->first) - (cell.first < parent->first);
+        int dc = parent == nullptr ? 0 : (cell.second > parent->second) - (cell.second < parent->second);
+
+        pacman_state_t jump_point;
+        if (dc == 0) {
+            // root or vertical move: every direction but back
+            for (int v : {-1, 1})
+                if (v != -dr && jump_vertical(cell, v, jump_point))
+                    *result++ = jump_point;
+            for (int h : {-1, 1})
+                if (jump_horizontal(cell, h, jump_point))
+                    *result++ = jump_point;
+            return;
+        }
+
+        // horizontal move: straight on and the forced turns
+        if (jump_horizontal(cell, dc, jump_point))
+            *result++ = jump_point;
+        for (int v : {-1, 1})
+            if (free(cell.first + v, cell.second) && !free(cell.first + v, cell.second - dc) &&
+                jump_vertical(cell, v, jump_point))
+                *result++ = jump_point;
+    }
+};
+
+// A* over jump points, a drop-in for the Manhattan A* that expands far fewer nodes on open maps.
+// The path is written cell by cell from goal to start, explored nodes are the expanded jump points.
+template <typename TResultPathIterator, typename TExploredNodeIterator>
+bool pacman_jps_search ( int r, int c, GridView const& grid,
+        pacman_state_t const& start, pacman_state_t const& goal,
+        TResultPathIterator result_path_it, TExploredNodeIterator explored_node_it ) {
+
+    // the heap and the bitmap are indexed by cell, and a goal off the grid is never reached
+    if (!PacmanCellIndex{r, c}.contains(start) || !PacmanCellIndex{r, c}.contains(goal))
+        return false;
+
+    using node_t = a_star_search::Node<pacman_state_t>;
+    PacmanStateFilter filter{r, c, grid};
+    PacmanJumpPointSearch jps(filter, goal);
+    a_star_search::ManhattanHeuristic<pacman_state_t> heuristic{goal};
+
+    a_star_search::NodeArena<node_t> nodes;
+    pacman_visited_t visited{PacmanCellIndex{r, c}};
+    pacman_frontier_t open{PacmanCellIndex{r, c}};
+
+    open.push(nodes.emplace(start, heuristic(start)));
+    visited.insert(start);
+
+    node_t* node = nullptr;
+    std::vector<pacman_state_t> jump_points;
+    while (!open.empty()) {
+        node = open.top();
+        open.pop();
+        *explored_node_it++ = node->state_;
+
+        if (node->state_ == goal)
+            break;
+
+        node_t const* parent = nodes.parent(*node);
+        jump_points.clear();
+        jps.successors(node->state_, parent == nullptr ? nullptr : &parent->state_, std::back_inserter(jump_points));
+
+        for (auto const& jp : jump_points) {
+            int cost = std::abs(jp.first - node->state_.first) + std::abs(jp.second - node->state_.second);
+            if (!visited.contains(jp)) {
+                visited.insert(jp);
+                open.push(nodes.emplace(jp, *node, heuristic(jp), cost));
+            } else if (node_t* queued = open.find(jp)) {
+                if (node->get_g_score() + cost < queued->get_g_score()) {
+                    queued->reparent(*node, cost);
+                    open.decrease_key(queued);
+                }
+            }
+        }
+        node = nullptr;
+    }
+
+    if (node == nullptr)
+        return false;
+
+    // fill in the cells between consecutive jump points
+    node_t const* it = node;
+    for (node_t const* parent = nodes.parent(*it); parent != nullptr; it = parent, parent = nodes.parent(*it)) {
+        int dr = (parent->state_.first > it->state_.first) - (parent->state_.first < it->state_.first);
+        int dc = (parent->state_.second > it->state_.second) - (parent->state_.second < it->state_.second);
+        for (pacman_state_t cell = it->state_; cell != parent->state_; cell.first += dr, cell.second += dc)
+            *result_path_it++ = cell;
+    }
+    *result_path_it++ = start;
+    return true;
+}
+
+void pacman_jps_solve ( int r, int c, int pacman_r, int pacman_c, int food_r, int food_c, GridView const& grid) {
+    std::vector<pacman_state_t> result_path; 
+    std::vector<pacman_state_t> explored_node; 
+
+    if (!pacman_jps_search(r, c, grid, {pacman_r, pacman_c}, {food_r, food_c},
+                           std::back_inserter(result_path), std::back_inserter(explored_node))) {
+        std::cout << -1 << std::endl;
+        return;
+    }
+
+    //print path length and path
+    std::cout << result_path.size()-1 << std::endl;
+    for ( auto r_it = result_path.rbegin(); r_it != result_path.rend(); ++r_it )
+        std::cout << r_it->first  << " " << r_it->second << std::endl;
+}
+
+// Level-synchronous BFS on `threads` threads, paths have the length of the sequential BFS ones
+template <typename TResultPathIterator>
+bool pacman_parallel_bfs_search ( int r, int c, GridView const& grid,
+        pacman_state_t const& start, pacman_state_t const& goal,
+        TResultPathIterator result_path_it,
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency()) ) {
+
+    // the start is claimed in the bitmap by its cell index, it has to be a free cell of the grid
+    PacmanStateFilter filter{r, c, grid};
+    if (!filter(start))
+        return false;
+
+    return a_star_search::parallel_bfs(start, goal,
+                                       PacmanNeighborFunctor{}, filter, PacmanCellIndex{r, c},
+                                       threads, result_path_it);
+}
+
+void pacman_parallel_bfs_solve ( int r, int c, int pacman_r, int pacman_c, int food_r, int food_c, GridView const& grid) {
+    std::vector<pacman_state_t> result_path; 
+
+    if (!pacman_parallel_bfs_search(r, c, grid, {pacman_r, pacman_c}, {food_r, food_c}, std::back_inserter(result_path))) {
+        std::cout << -1 << std::endl;
+        return;
+    }
+
+    //print path length and path
+    std::cout << result_path.size()-1 << std::endl;
+    for ( auto r_it = result_path.rbegin(); r_it != result_path.rend(); ++r_it )
+        std::cout << r_it->first  << " " << r_it->second << std::endl;
+}
+
+// Direction-optimizing BFS (Beamer, Asanovic and Patterson, 2012) over bitsets of the grid.
+// Small levels are expanded top-down in queue order. Large ones are swept bottom-up: every
+// unvisited cell next to the frontier bitmap picks the frontier cell that comes first in the
+// queue as its parent, and the new level is ordered by (parent rank, direction). Both ways give
+// the tree, distances and pop order of the queue-based pacman BFS with UP, LEFT, RIGHT, DOWN moves.
+class PacmanDirectionOptimizingBfs {
+public:
+    static constexpr std::uint32_t unreachable = std::numeric_limits<std::uint32_t>::max();
+    // direction of the move from the parent, an index into the UP, LEFT, RIGHT, DOWN order
+    static constexpr std::uint8_t no_parent = 4;
+
+private:
+    // Beamer's switching thresholds: bottom-up when the frontier has more than 1/alpha of the
+    // unvisited cells, back to top-down when it drops under 1/beta of the grid
+    static constexpr std::size_t alpha_ = 14;
+    static constexpr std::size_t beta_ = 24;
+
+    int r_, c_;
+    std::size_t words_;
+    // one row of bits starts every words_ words
+    std::vector<std::uint64_t> free_, visited_, frontier_;
+    std::vector<std::uint32_t> distance_;
+    std::vector<std::uint8_t> parent_;
+    // position of every frontier cell in the current level
+    std::vector<std::uint32_t> rank_;
+    std::vector<std::uint32_t> level_, next_, slots_;
+    std::size_t top_down_levels_{0}, bottom_up_levels_{0};
+
+    static bool test ( std::vector<std::uint64_t> const& bits, std::size_t word, unsigned bit ) { return (bits[word] >> bit) & 1; }
+    std::size_t word_of ( int i, int j ) const { return std::size_t(i) * words_ + j / 64; }
+    bool contains ( pacman_state_t const& cell ) const { return cell.first >= 0 && cell.first < r_ && cell.second >= 0 && cell.second < c_; }
+
+    void visit ( std::uint32_t cell, std::uint32_t distance, std::uint8_t parent ) {
+        int i = cell / c_, j = cell % c_;
+        visited_[word_of(i, j)] |= std::uint64_t(1) << (j % 64);
+        distance_[cell] = distance;
+        parent_[cell] = parent;
+    }
+
+    void top_down ( std::uint32_t distance ) {
+        for (std::uint32_t cell : level_) {
+            int i = cell / c_, j = cell % c_;
+            for (std::uint8_t d = 0; d < 4; ++d) {
+                int ni = i + PacmanNeighborFunctor::shifts[d].first, nj = j + PacmanNeighborFunctor::shifts[d].second;
+                if (ni < 0 || ni >= r_ || nj < 0 || nj >= c_)
+                    continue;
+                std::size_t w = word_of(ni, nj);
+                unsigned b = nj % 64;
+                if (test(free_, w, b) && !test(visited_, w, b)) {
+                    std::uint32_t next = std::uint32_t(ni) * c_ + nj;
+                    visit(next, distance, d);
+                    next_.push_back(next);
+                }
+            }
+        }
+    }
+
+    void bottom_up ( std::uint32_t distance ) {
+        int top = r_, bottom = -1;
+        for (std::uint32_t cell : level_) {
+            top = std::min<int>(top, cell / c_);
+            bottom = std::max<int>(bottom, cell / c_);
+        }
+
+        // a cell is reached from the frontier cell of the lowest rank; keys rank * 4 + direction
+        // are unique, so placing cells at their key sorts the level into queue order
+        slots_.assign(level_.size() * 4, 0);
+        for (int i = std::max(0, top - 1); i <= std::min(r_ - 1, bottom + 1); ++i) {
+            for (std::size_t w = 0; w < words_; ++w) {
+                std::size_t at = std::size_t(i) * words_ + w;
+                std::uint64_t f = frontier_[at];
+                std::uint64_t near = (f << 1) | (f >> 1);
+                if (w > 0) near |= frontier_[at - 1] >> 63;
+                if (w + 1 < words_) near |= frontier_[at + 1] << 63;
+                if (i > 0) near |= frontier_[at - words_];
+                if (i + 1 < r_) near |= frontier_[at + words_];
+
+                for (std::uint64_t candidates = near & free_[at] & ~visited_[at]; candidates; candidates &= candidates - 1) {
+                    int j = int(w * 64) + __builtin_ctzll(candidates);
+                    std::uint32_t best = std::numeric_limits<std::uint32_t>::max();
+                    std::uint8_t best_d = no_parent;
+                    for (std::uint8_t d = 0; d < 4; ++d) {
+                        // the parent sits against the move that reaches this cell
+                        int pi = i - PacmanNeighborFunctor::shifts[d].first, pj = j - PacmanNeighborFunctor::shifts[d].second;
+                        if (pi < 0 || pi >= r_ || pj < 0 || pj >= c_ || !test(frontier_, word_of(pi, pj), pj % 64))
+                            continue;
+                        std::uint32_t rank = rank_[std::size_t(pi) * c_ + pj];
+                        if (rank < best) {
+                            best = rank;
+                            best_d = d;
+                        }
+                    }
+                    std::uint32_t cell = std::uint32_t(i) * c_ + j;
+                    visit(cell, distance, best_d);
+                    slots_[best * 4 + best_d] = cell + 1;
+                }
+            }
+        }
+        for (std::uint32_t slot : slots_)
+            if (slot != 0)
+                next_.push_back(slot - 1);
+    }
+
+    void set_frontier ( std::vector<std::uint32_t> const& cells, bool on ) {
+        for (std::size_t k = 0; k < cells.size(); ++k) {
+            int i = cells[k] / c_, j = cells[k] % c_;
+            if (on) {
+                frontier_[word_of(i, j)] |= std::uint64_t(1) << (j % 64);
+                rank_[cells[k]] = k;
+            } else {
+                frontier_[word_of(i, j)] &= ~(std::uint64_t(1) << (j % 64));
+            }
+        }
+    }
+
+public:
+    explicit PacmanDirectionOptimizingBfs ( PacmanStateFilter const& filter ) : r_(filter.r_)
+                                                                             , c_(filter.c_)
+                                                                             , words_((filter.c_ + 63) / 64)
+                                                                             , free_(std::size_t(r_) * words_, 0) {
+        for (int i = 0; i < r_; ++i)
+            for (int j = 0; j < c_; ++j)
+                if (filter({i, j}))
+                    free_[word_of(i, j)] |= std::uint64_t(1) << (j % 64);
+    }
+
+    // BFS from the source, up to the goal when it is given. Writes cells in the order the queue
+    // BFS pops them, the goal included, and returns whether the goal was reached. A source off
+    // the grid or on a wall reaches nothing and the search returns false.
+    template <typename TExploredNodeIterator>
+    bool search ( pacman_state_t const& source, pacman_state_t const* goal, TExploredNodeIterator explored_node_it ) {
+        std::size_t cells = std::size_t(r_) * c_;
+        visited_.assign(free_.size(), 0);
+        frontier_.assign(free_.size(), 0);
+        distance_.assign(cells, unreachable);
+        parent_.assign(cells, no_parent);
+        rank_.resize(cells);
+        top_down_levels_ = bottom_up_levels_ = 0;
+
+        if (!contains(source) || !test(free_, word_of(source.first, source.second), source.second % 64))
+            return false;
+
+        // a goal off the grid would alias a cell of another row
+        std::uint32_t goal_cell = goal && contains(*goal) ? std::uint32_t(goal->first) * c_ + goal->second : unreachable;
+        level_.assign(1, std::uint32_t(source.first) * c_ + source.second);
+        visit(level_[0], 0, no_parent);
+
+        std::size_t unvisited = 0;
+        for (auto w : free_)
+            unvisited += __builtin_popcountll(w);
+        unvisited -= 1;
+
+        bool bottom_up_mode = false;
+        for (std::uint32_t distance = 1; !level_.empty(); ++distance) {
+            for (std::uint32_t cell : level_) {
+                *explored_node_it++ = pacman_state_t(cell / c_, cell % c_);
+                if (cell == goal_cell)
+                    return true;
+            }
+
+            if (!bottom_up_mode && level_.size() * alpha_ > unvisited)
+                bottom_up_mode = true;
+            else if (bottom_up_mode && level_.size() * beta_ < cells)
+                bottom_up_mode = false;
+
+            next_.clear();
+            if (bottom_up_mode) {
+                set_frontier(level_, true);
+                bottom_up(distance);
+                set_frontier(level_, false);
+                ++bottom_up_levels_;
+            } else {
+                top_down(distance);
+                ++top_down_levels_;
+            }
+            unvisited -= next_.size();
+            level_.swap(next_);
+        }
+        return goal == nullptr;
+    }
+
+    std::uint32_t distance ( pacman_state_t const& cell ) const { return distance_[std::size_t(cell.first) * c_ + cell.second]; }
+    std::uint8_t parent_direction ( pacman_state_t const& cell ) const { return parent_[std::size_t(cell.first) * c_ + cell.second]; }
+
+    std::size_t top_down_levels () const { return top_down_levels_; }
+    std::size_t bottom_up_levels () const { return bottom_up_levels_; }
+
+    // Path from the cell back to the source of the last search
+    template <typename TResultPathIterator>
+    void path ( pacman_state_t cell, TResultPathIterator result_path_it ) const {
+        *result_path_it++ = cell;
+        for (std::uint8_t d; (d = parent_direction(cell)) != no_parent; ) {
+            cell = {cell.first - PacmanNeighborFunctor::shifts[d].first, cell.second - PacmanNeighborFunctor::shifts[d].second};
+            *result_path_it++ = cell;
+        }
+    }
+};
+
+constexpr std::uint32_t PacmanDirectionOptimizingBfs::unreachable;
+constexpr std::uint8_t PacmanDirectionOptimizingBfs::no_parent;
+constexpr std::size_t PacmanDirectionOptimizingBfs::alpha_;
+constexpr std::size_t PacmanDirectionOptimizingBfs::beta_;
+
+// Shortest path lengths from the source to every cell of the grid (BFS), cells that cannot
+// be reached get PacmanLandmarks::unreachable, all of them when the source is not a free cell
+void pacman_distances ( PacmanStateFilter const& filter, pacman_state_t const& source, std::vector<std::uint32_t>& distances );
+
+// Landmark distance tables of one grid for the ALT heuristic.
+// Landmarks are spread over the free cells with farthest-point selection and
+// BFS distances from each of them to every cell are stored cell by cell.
+class PacmanLandmarks {
+public:
+    static constexpr std::uint32_t unreachable = std::numeric_limits<std::uint32_t>::max();
+
+private:
+    int r_{0}, c_{0};
+    std::vector<pacman_state_t> landmarks_;
+    // distance of landmark l to cell i is distances_[i * landmarks_.size() + l]
+    std::vector<std::uint32_t> distances_;
+
+    static constexpr char file_magic_[8] = {'P', 'A', 'C', 'A', 'L', 'T', '1', '\0'};
+
+    // Farthest-point selection by Manhattan distance over free cells. Grid distances would
+    // need the tables of the landmarks picked so far and serialize the BFS runs.
+    static std::vector<pacman_state_t> select ( PacmanStateFilter const& filter, std::size_t count ) {
+        std::vector<pacman_state_t> cells;
+        for (int i = 0; i < filter.r_; ++i)
+            for (int j = 0; j < filter.c_; ++j)
+                if (filter({i, j}))
+                    cells.push_back({i, j});
+
+        std::vector<pacman_state_t> landmarks;
+        if (cells.empty())
+            return landmarks;
+
+        std::vector<int> nearest(cells.size(), std::numeric_limits<int>::max());
+        // the first free cell only seeds the selection and is not a landmark
+        pacman_state_t next = cells.front();
+        for (std::size_t l = 0; l <= count && l < cells.size(); ++l) {
+            if (l > 0)
+                landmarks.push_back(next);
+
+            a_star_search::ManhattanHeuristic<pacman_state_t> distance{next};
+            std::size_t farthest = 0;
+            for (std::size_t i = 0; i < cells.size(); ++i) {
+                nearest[i] = std::min(nearest[i], distance(cells[i]));
+                if (nearest[i] > nearest[farthest])
+                    farthest = i;
+            }
+            next = cells[farthest];
+        }
+        return landmarks;
+    }
+
+public:
+    PacmanLandmarks () = default;
+
+    // Builds the tables with one BFS per landmark, spread over `threads` threads
+    PacmanLandmarks ( PacmanStateFilter const& filter, std::size_t count,
+                      unsigned threads = std::max(1u, std::thread::hardware_concurrency()) ) : r_(filter.r_)
+                                                                                             , c_(filter.c_)
+                                                                                             , landmarks_(select(filter, count)) {
+        threads = std::max(1u, threads);
+        std::size_t cells = std::size_t(r_) * c_;
+        std::size_t k = landmarks_.size();
+        std::vector<std::vector<std::uint32_t>> tables(k);
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < std::min<std::size_t>(threads, k); ++t)
+            workers.emplace_back([&, t]() {
+                for (std::size_t l = t; l < k; l += threads)
+                    pacman_distances(filter, landmarks_[l], tables[l]);
+            });
+        for (auto& w : workers)
+            w.join();
+
+        distances_.resize(cells * k);
+        for (std::size_t l = 0; l < k; ++l)
+            for (std::size_t i = 0; i < cells; ++i)
+                distances_[i * k + l] = tables[l][i];
+    }
+
+    std::size_t size () const { return landmarks_.size(); }
+    std::vector<pacman_state_t> const& landmarks () const { return landmarks_; }
+
+    bool contains ( pacman_state_t const& cell ) const { return PacmanCellIndex{r_, c_}.contains(cell); }
+
+    // Distances of all landmarks to the cell, which has to be on the grid
+    std::uint32_t const* distances ( pacman_state_t const& cell ) const {
+        return &distances_[PacmanCellIndex{r_, c_}(cell) * landmarks_.size()];
+    }
+
+    void save ( std::string const& file_name ) const {
+        std::ofstream out(file_name, std::ios::binary);
+        std::int32_t header[3] = {r_, c_, std::int32_t(landmarks_.size())};
+        out.write(file_magic_, sizeof(file_magic_));
+        out.write(reinterpret_cast<char const*>(header), sizeof(header));
+        for (auto const& l : landmarks_) {
+            std::int32_t cell[2] = {l.first, l.second};
+            out.write(reinterpret_cast<char const*>(cell), sizeof(cell));
+        }
+        out.write(reinterpret_cast<char const*>(distances_.data()), distances_.size() * sizeof(std::uint32_t));
+        if (!out)
+            throw std::runtime_error("PacmanLandmarks: cannot write " + file_name);
+    }
+
+    static PacmanLandmarks load ( std::string const& file_name ) {
+        std::ifstream in(file_name, std::ios::binary);
+        char magic[sizeof(file_magic_)];
+        std::int32_t header[3];
+        in.read(magic, sizeof(magic));
+        in.read(reinterpret_cast<char*>(header), sizeof(header));
+        if (!in || !std::equal(magic, magic + sizeof(magic), file_magic_) || header[0] < 0 || header[1] < 0 || header[2] < 0)
+            throw std::runtime_error("PacmanLandmarks: " + file_name + " is not a landmark file");
+
+        PacmanLandmarks landmarks;
+        landmarks.r_ = header[0];
+        landmarks.c_ = header[1];
+        landmarks.landmarks_.resize(header[2]);
+        for (auto& l : landmarks.landmarks_) {
+            std::int32_t cell[2];
+            in.read(reinterpret_cast<char*>(cell), sizeof(cell));
+            l = {cell[0], cell[1]};
+        }
+        landmarks.distances_.resize(std::size_t(landmarks.r_) * landmarks.c_ * landmarks.landmarks_.size());
+        in.read(reinterpret_cast<char*>(landmarks.distances_.data()), landmarks.distances_.size() * sizeof(std::uint32_t));
+        if (!in)
+            throw std::runtime_error("PacmanLandmarks: " + file_name + " is truncated");
+        return landmarks;
+    }
+};
+
+constexpr std::uint32_t PacmanLandmarks::unreachable;
+constexpr char PacmanLandmarks::file_magic_[8];
+
+void pacman_distances ( PacmanStateFilter const& filter, pacman_state_t const& source, std::vector<std::uint32_t>& distances ) {
+    PacmanCellIndex index{filter.r_, filter.c_};
+    distances.assign(index.size(), PacmanLandmarks::unreachable);
+    if (!filter(source))
+        return;
+
+    std::vector<pacman_state_t> queue{source};
+    distances[index(source)] = 0;
+    std::vector<pacman_state_t> neighbors;
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        pacman_state_t current = queue[head];
+        std::uint32_t d = distances[index(current)] + 1;
+
+        neighbors.clear();
+        PacmanNeighborFunctor{}(current, std::back_inserter(neighbors));
+        for (auto const& n : neighbors)
+            if (filter(n) && distances[index(n)] == PacmanLandmarks::unreachable) {
+                distances[index(n)] = d;
+                queue.push_back(n);
+            }
+    }
+}
+
+// Distances from every source to every cell, the distance of source s to cell i is
+// distances[i * sources.size() + s] like in PacmanLandmarks. The sources go through
+// multi_source_bfs in batches of 64; the runs share work where their waves meet a cell
+// at the same distance, which is most of the time for sources close to each other.
+void pacman_multi_source_distances ( PacmanStateFilter const& filter, std::vector<pacman_state_t> const& sources,
+                                     std::vector<std::uint32_t>& distances ) {
+    PacmanCellIndex index{filter.r_, filter.c_};
+    std::size_t k = sources.size();
+    distances.assign(index.size() * k, PacmanLandmarks::unreachable);
+
+    for (std::size_t first = 0; first < k; first += 64) {
+        std::vector<pacman_state_t> batch(sources.begin() + first, sources.begin() + std::min(k, first + 64));
+        a_star_search::multi_source_bfs(batch, PacmanNeighborFunctor{}, filter, index,
+            [&](std::size_t i, std::uint64_t mask, std::uint32_t d) {
+                std::uint32_t* row = &distances[i * k + first];
+                for (; mask; mask &= mask - 1)
+                    row[__builtin_ctzll(mask)] = d;
+            });
+    }
+}
+
+// Distance to the nearest source and the index of that source for every cell, ties go to
+// the lower index. Cells that no source reaches get PacmanLandmarks::unreachable in both,
+// sources off the grid or on a wall reach nothing.
+// One BFS from all the sources: the nearest sources of a cell are those of its neighbors one
+// level closer, so the lowest index of them is final once the level is done.
+void pacman_nearest_source ( PacmanStateFilter const& filter, std::vector<pacman_state_t> const& sources,
+                             std::vector<std::uint32_t>& distances, std::vector<std::uint32_t>& nearest ) {
+    PacmanCellIndex index{filter.r_, filter.c_};
+    distances.assign(index.size(), PacmanLandmarks::unreachable);
+    nearest.assign(index.size(), PacmanLandmarks::unreachable);
+
+    std::vector<pacman_state_t> level, next, neighbors;
+    for (std::size_t s = 0; s < sources.size(); ++s) {
+        if (!filter(sources[s]))
+            continue;
+        std::size_t i = index(sources[s]);
+        if (distances[i] == 0)
+            continue;
+        distances[i] = 0;
+        nearest[i] = s;
+        level.push_back(sources[s]);
+    }
+
+    for (std::uint32_t d = 1; !level.empty(); ++d) {
+        next.clear();
+        for (auto const& current : level) {
+            std::uint32_t source = nearest[index(current)];
+            neighbors.clear();
+            PacmanNeighborFunctor{}(current, std::back_inserter(neighbors));
+            for (auto const& n : neighbors) {
+                if (!filter(n))
+                    continue;
+                std::size_t j = index(n);
+                if (distances[j] == PacmanLandmarks::unreachable) {
+                    distances[j] = d;
+                    nearest[j] = source;
+                    next.push_back(n);
+                } else if (distances[j] == d) {
+                    nearest[j] = std::min(nearest[j], source);
+                }
+            }
+        }
+        level.swap(next);
+    }
+}
 
-    struct AStarComparator{
-        bool operator() ( pacman_node_t const l, pacman_node_t const r ) { return l->get_total_score() < r->get_total_score(); }
-    };
+// Shortest path lengths from every cell to a fixed goal, built once with a BFS from the goal
+// (moves are symmetric on the grid). A path from any start then follows the distances down in
+// O(path length), taking the first of the UP, LEFT, RIGHT, DOWN moves that gets one step closer.
+// Changes of the grid or the goal invalidate the field, it is rebuilt on the next query.
+class PacmanDistanceField {
+    PacmanStateFilter filter_;
+    pacman_state_t goal_;
+    std::vector<std::uint32_t> distances_;
+    bool valid_{false};
+
+    void refresh () {
+        if (valid_)
+            return;
+        // searches never step onto a wall, a goal off the grid or on a wall leaves every cell unreachable
+        if (filter_(goal_))
+            pacman_distances(filter_, goal_, distances_);
+        else
+            distances_.assign(std::size_t(filter_.r_) * filter_.c_, PacmanLandmarks::unreachable);
+        valid_ = true;
+    }
 
-    a_star_search::NodeVisitor<pacman_state_t,
-        PacmanNeighborFunctor, PacmanStateFilter,
-        std::priority_queue<pacman_node_t, std::vector<pacman_node_t>, AStarComparator>,
-        AStarHeuristic> pacman_node_visitor(PacmanStateFilter{r, c, grid}, AStarHeuristic{food_r, food_c});
+public:
+    PacmanDistanceField ( PacmanStateFilter filter, pacman_state_t const& goal ) : filter_(std::move(filter)), goal_(goal) { refresh(); }
 
-    a_star_search::a_star<pacman_state_t> ( 
-            {pacman_r, pacman_c},
-            {food_r, food_c},
-            pacman_node_visitor,
-            std::back_inserter(result_path),
-            std::back_inserter(explored_node)
-          );
+    pacman_state_t const& goal () const { return goal_; }
+    bool valid () const { return valid_; }
+
+    // Hook for changes the field cannot see, the next query rebuilds it
+    void invalidate () { valid_ = false; }
+
+    void set_goal ( pacman_state_t const& goal ) {
+        if (goal != goal_)
+            invalidate();
+        goal_ = goal;
+    }
+
+    // Changes a grid cell. Only walls matter to the field, so only a cell that turns into
+    // a wall or stops being one gets a new grid (the view is shared) and invalidates the field.
+    // Cells off the grid are ignored.
+    void set_cell ( pacman_state_t const& cell, char value ) {
+        if (!PacmanCellIndex{filter_.r_, filter_.c_}.contains(cell))
+            return;
+        if ((filter_.grid_[cell.first][cell.second] == '%') == (value == '%'))
+            return;
+        filter_.grid_ = filter_.grid_.with_cell(cell, value);
+        invalidate();
+    }
+
+    // PacmanLandmarks::unreachable for cells without a path to the goal
+    std::uint32_t distance ( pacman_state_t const& cell ) {
+        refresh();
+        return filter_(cell) ? distances_[std::size_t(cell.first) * filter_.c_ + cell.second] : PacmanLandmarks::unreachable;
+    }
+
+    // Writes the path from the start to the goal, both included, and returns whether there is one
+    template <typename TResultPathIterator>
+    bool path ( pacman_state_t cell, TResultPathIterator result_path_it ) {
+        std::uint32_t d = distance(cell);
+        if (d == PacmanLandmarks::unreachable)
+            return false;
+
+        *result_path_it++ = cell;
+        for (; d > 0; --d) {
+            pacman_state_t neighbors[4];
+            PacmanNeighborFunctor{}(cell, neighbors);
+            for (auto const& n : neighbors)
+                if (filter_(n) && distances_[std::size_t(n.first) * filter_.c_ + n.second] == d - 1) {
+                    cell = n;
+                    break;
+                }
+            *result_path_it++ = cell;
+        }
+        return true;
+    }
+};
+
+void pacman_distance_field_solve ( int r, int c, int pacman_r, int pacman_c, int food_r, int food_c, GridView const& grid) {
+    std::vector<pacman_state_t> result_path; 
+
+    PacmanDistanceField field(PacmanStateFilter{r, c, grid}, {food_r, food_c});
+    if (!field.path({pacman_r, pacman_c}, std::back_inserter(result_path))) {
+        std::cout << -1 << std::endl;
+        return;
+    }
 
     //print path length and path
     std::cout << result_path.size()-1 << std::endl;
-    for ( auto r_it = result_path.rbegin(); r_it != result_path.rend(); ++r_it )
-        std::cout << r_it->first  << " " << r_it->second << std::endl;
+    for (auto const& cell : result_path)
+        std::cout << cell.first  << " " << cell.second << std::endl;
 }
 
+// ALT heuristic. On the undirected grid the triangle inequality gives
+// |d(L, goal) - d(L, state)| <= d(state, goal) for every landmark L.
+// Landmarks that do not reach the state or the goal are skipped.
+class PacmanLandmarkHeuristic {
+    PacmanLandmarks const* landmarks_;
+    std::vector<std::uint32_t> goal_distances_;
+
+public:
+    // A goal off the grid has no table row, no landmark reaches it and the heuristic is 0
+    PacmanLandmarkHeuristic ( PacmanLandmarks const& landmarks, pacman_state_t const& goal )
+        : landmarks_(&landmarks)
+        , goal_distances_(landmarks.size(), PacmanLandmarks::unreachable) {
+        if (landmarks.contains(goal))
+            std::copy(landmarks.distances(goal), landmarks.distances(goal) + landmarks.size(), goal_distances_.begin());
+    }
+
+    int operator() ( pacman_state_t const& state ) const {
+        std::uint32_t const* d = landmarks_->distances(state);
+        std::uint32_t h = 0;
+        for (std::size_t l = 0; l < goal_distances_.size(); ++l) {
+            if (d[l] == PacmanLandmarks::unreachable || goal_distances_[l] == PacmanLandmarks::unreachable)
+                continue;
+            h = std::max(h, d[l] > goal_distances_[l] ? d[l] - goal_distances_[l] : goal_distances_[l] - d[l]);
+        }
+        return int(h);
+    }
+};
+
+// One wavefront step over n words of a row of a bit grid:
+// next = (frontier cells next to the word's cells) & free & ~visited, then visited |= next.
+// up, mid and down are the frontier words of the rows above, at and below; mid[-1] and mid[n] must exist.
+inline void pacman_wavefront ( std::uint64_t const* up, std::uint64_t const* mid, std::uint64_t const* down,
+                               std::uint64_t const* free, std::uint64_t* visited, std::uint64_t* next, std::size_t n ) {
+    for (std::size_t w = 0; w < n; ++w) {
+        std::uint64_t grown = up[w] | down[w] | mid[w] << 1 | mid[w - 1] >> 63 | mid[w] >> 1 | mid[w + 1] << 63;
+        next[w] = grown & free[w] & ~visited[w];
+        visited[w] |= next[w];
+    }
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define PACMAN_HAS_AVX2_KERNELS 1
+
+__attribute__((target("avx2")))
+inline __m256i pacman_load ( std::uint64_t const* p ) { return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)); }
+
+// pacman_wavefront four words at a time
+__attribute__((target("avx2")))
+inline void pacman_wavefront_avx2 ( std::uint64_t const* up, std::uint64_t const* mid, std::uint64_t const* down,
+                                    std::uint64_t const* free, std::uint64_t* visited, std::uint64_t* next, std::size_t n ) {
+    std::size_t w = 0;
+    for (; w + 4 <= n; w += 4) {
+        __m256i f = pacman_load(mid + w);
+        __m256i vertical = _mm256_or_si256(pacman_load(up + w), pacman_load(down + w));
+        __m256i horizontal = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi64(f, 1), _mm256_srli_epi64(pacman_load(mid + w - 1), 63)),
+                                             _mm256_or_si256(_mm256_srli_epi64(f, 1), _mm256_slli_epi64(pacman_load(mid + w + 1), 63)));
+        __m256i v = pacman_load(visited + w);
+        __m256i reached = _mm256_andnot_si256(v, _mm256_and_si256(_mm256_or_si256(vertical, horizontal), pacman_load(free + w)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(next + w), reached);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(visited + w), _mm256_or_si256(v, reached));
+    }
+    pacman_wavefront(up + w, mid + w, down + w, free + w, visited + w, next + w, n - w);
+}
+
+inline bool pacman_has_avx2 () {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+#endif
+
+// Grid with one bit per free cell in 64-bit words. Every row has a zero guard word on both sides
+// and there are zero guard rows above and below, so the wavefront kernels need no bounds checks.
+class PacmanBitGrid {
+public:
+    static constexpr std::uint32_t unreachable = std::numeric_limits<std::uint32_t>::max();
+
+private:
+    int r_, c_;
+    std::size_t words_, stride_;
+    std::vector<std::uint64_t> free_;
+
+    std::size_t at ( int i, std::size_t w ) const { return std::size_t(i + 1) * stride_ + w + 1; }
+
+public:
+    explicit PacmanBitGrid ( PacmanStateFilter const& filter ) : r_(filter.r_)
+                                                              , c_(filter.c_)
+                                                              , words_((filter.c_ + 63) / 64)
+                                                              , stride_(words_ + 2)
+                                                              , free_(std::size_t(r_ + 2) * stride_, 0) {
+        for (int i = 0; i < r_; ++i)
+            for (int j = 0; j < c_; ++j)
+                if (filter({i, j}))
+                    free_[at(i, j / 64)] |= std::uint64_t(1) << (j % 64);
+    }
+
+    int rows () const { return r_; }
+    int cols () const { return c_; }
+    bool contains ( pacman_state_t const& cell ) const { return cell.first >= 0 && cell.first < r_ && cell.second >= 0 && cell.second < c_; }
+    bool is_free ( pacman_state_t const& cell ) const { return (free_[at(cell.first, cell.second / 64)] >> (cell.second % 64)) & 1; }
+
+private:
+    template <typename FWavefront>
+    void flood ( pacman_state_t const& source, std::vector<std::uint32_t>& distances, FWavefront const& wavefront ) const {
+        distances.assign(std::size_t(r_) * c_, unreachable);
+        if (!contains(source) || !is_free(source))
+            return;
+        distances[std::size_t(source.first) * c_ + source.second] = 0;
+
+        std::vector<std::uint64_t> frontier(free_.size(), 0), next(free_.size(), 0), visited(free_.size(), 0);
+        // frontier words of row i are in [lo[i + 1], hi[i + 1]), the guard rows stay empty
+        std::vector<std::size_t> lo(r_ + 2, words_), hi(r_ + 2, 0), next_lo(r_ + 2, words_), next_hi(r_ + 2, 0);
+
+        std::size_t source_word = source.second / 64;
+        frontier[at(source.first, source_word)] = visited[at(source.first, source_word)] = std::uint64_t(1) << (source.second % 64);
+        lo[source.first + 1] = source_word;
+        hi[source.first + 1] = source_word + 1;
+
+        int top = source.first, bottom = source.first;
+        for (std::uint32_t d = 1; top <= bottom; ++d) {
+            int next_top = r_, next_bottom = -1;
+            for (int i = std::max(0, top - 1); i <= std::min(r_ - 1, bottom + 1); ++i) {
+                std::size_t from = std::min({lo[i], lo[i + 1], lo[i + 2]}), to = std::max({hi[i], hi[i + 1], hi[i + 2]});
+                next_lo[i + 1] = words_;
+                next_hi[i + 1] = 0;
+                if (from >= to)
+                    continue;
+                from = from > 0 ? from - 1 : 0;
+                to = std::min(words_, to + 1);
+
+                std::size_t row = at(i, 0);
+                wavefront(&frontier[row - stride_ + from], &frontier[row + from], &frontier[row + stride_ + from],
+                          &free_[row + from], &visited[row + from], &next[row + from], to - from);
+
+                for (std::size_t w = from; w < to; ++w) {
+                    std::uint64_t bits = next[row + w];
+                    if (bits == 0)
+                        continue;
+                    next_lo[i + 1] = std::min(next_lo[i + 1], w);
+                    next_hi[i + 1] = w + 1;
+                    next_top = std::min(next_top, i);
+                    next_bottom = std::max(next_bottom, i);
+                    for (; bits; bits &= bits - 1)
+                        distances[std::size_t(i) * c_ + w * 64 + __builtin_ctzll(bits)] = d;
+                }
+            }
+
+            for (int i = top; i <= bottom; ++i) {
+                std::fill(frontier.begin() + at(i, lo[i + 1]), frontier.begin() + at(i, std::max(lo[i + 1], hi[i + 1])), 0);
+                lo[i + 1] = words_;
+                hi[i + 1] = 0;
+            }
+            frontier.swap(next);
+            lo.swap(next_lo);
+            hi.swap(next_hi);
+            top = next_top;
+            bottom = next_bottom;
+        }
+    }
+
+public:
+    // Shortest path lengths from the source to every cell, the same as pacman_distances:
+    // a source off the grid or on a wall reaches nothing.
+    // The frontier grows one step per level over whole words; each row only touches
+    // the words next to the frontier words of the rows around it.
+    void distance_field ( pacman_state_t const& source, std::vector<std::uint32_t>& distances, bool vectorized = true ) const {
+#ifdef PACMAN_HAS_AVX2_KERNELS
+        if (vectorized && pacman_has_avx2())
+            return flood(source, distances, pacman_wavefront_avx2);
+#else
+        (void)vectorized;
+#endif
+        flood(source, distances, pacman_wavefront);
+    }
+};
+
+constexpr std::uint32_t PacmanBitGrid::unreachable;
+
+// Answers many (pacman, food) queries on one grid with A* and the Manhattan heuristic. Every worker
+// keeps one visitor and clears it between queries, so the visited bitmap, the frontier and the node
+// blocks are allocated once per worker; the grid is shared by all. Queries are handed out in small chunks.
+class PacmanBatchSolver {
+public:
+    struct Query {
+        pacman_state_t start_, goal_;
+    };
+
+private:
+    using heuristic_t = a_star_search::ManhattanHeuristic<pacman_state_t>;
+    using visitor_t = pacman_visitor_t<pacman_frontier_t, heuristic_t>;
+
+    static constexpr std::size_t chunk_ = 16;
+
+    PacmanStateFilter filter_;
+    std::vector<std::unique_ptr<visitor_t>> visitors_;
+
+public:
+    explicit PacmanBatchSolver ( PacmanStateFilter const& filter,
+                                 unsigned threads = std::max(1u, std::thread::hardware_concurrency()) ) : filter_(filter) {
+        PacmanCellIndex index{filter_.r_, filter_.c_};
+        for (unsigned t = 0; t < std::max(1u, threads); ++t)
+            visitors_.emplace_back(new visitor_t(filter_, heuristic_t{}, pacman_visited_t{index}, pacman_frontier_t{index}));
+    }
+
+    std::size_t threads () const { return visitors_.size(); }
+
+    // paths[q] is the path of query q from the food back to pacman as a_star writes it,
+    // empty when the food cannot be reached or pacman or the food is off the grid or on a wall
+    void solve ( std::vector<Query> const& queries, std::vector<std::vector<pacman_state_t>>& paths ) {
+        paths.resize(queries.size());
+        std::atomic<std::size_t> cursor{0};
+
+        auto work = [&](visitor_t& visitor) {
+            for (std::size_t first; (first = cursor.fetch_add(chunk_)) < queries.size(); ) {
+                for (std::size_t q = first; q < std::min(first + chunk_, queries.size()); ++q) {
+                    auto& path = paths[q];
+                    path.clear();
+                    // the root skips the filter, and the visited bitmap and the heap are indexed by cell
+                    if (!filter_(queries[q].start_) || !filter_(queries[q].goal_))
+                        continue;
+                    visitor.clear(heuristic_t{queries[q].goal_});
+                    std::size_t explored = 0;
+                    a_star_search::a_star<pacman_state_t>(queries[q].start_, queries[q].goal_, visitor,
+                                                          std::back_inserter(path), a_star_search::CountingIterator{&explored});
+                    if (path.empty() || path.front() != queries[q].goal_)
+                        path.clear();
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (std::size_t t = 1; t < visitors_.size(); ++t)
+            workers.emplace_back(work, std::ref(*visitors_[t]));
+        work(*visitors_[0]);
+        for (auto& w : workers)
+            w.join();
+    }
+};
+
 template <typename TSolveFunction>
 void read_data( TSolveFunction const& solve_function ) {
     int r,c, pacman_r, pacman_c, food_r, food_c;
@@ -327,53 +3048,782 @@ void read_data( TSolveFunction const& solve_function ) {
         grid.push_back(s);
     }
 
-    solve_function(r, c, pacman_r, pacman_c, food_r, food_c, grid);
+    solve_function(r, c, pacman_r, pacman_c, food_r, food_c, GridView(grid));
+}
+
+// Batch mode: the grid size and the grid once, then "pacman_r pacman_c food_r food_c" queries up
+// to the end of the input. Prints one line per query in input order, the path length followed by
+// the cells from pacman to the food, or -1 when the food cannot be reached or a query has
+// a cell off the grid or on a wall.
+void read_batch ( unsigned threads = std::max(1u, std::thread::hardware_concurrency()) ) {
+    static constexpr std::size_t block = 1 << 14;
+
+    int r, c;
+    std::cin >> r >> c;
+
+    std::vector <std::string> grid;
+    for (int i = 0; i < r; i++) {
+        std::string s; std::cin >> s;
+        grid.push_back(s);
+    }
+
+    PacmanBatchSolver solver(PacmanStateFilter{r, c, grid}, threads);
+    std::vector<PacmanBatchSolver::Query> queries;
+    std::vector<std::vector<pacman_state_t>> paths;
+    for (bool more = true; more; ) {
+        queries.clear();
+        PacmanBatchSolver::Query q;
+        while (queries.size() < block && (more = bool(std::cin >> q.start_.first >> q.start_.second >> q.goal_.first >> q.goal_.second)))
+            queries.push_back(q);
+
+        solver.solve(queries, paths);
+        for (auto const& path : paths) {
+            std::cout << (path.empty() ? -1 : int(path.size()) - 1);
+            for (auto r_it = path.rbegin(); r_it != path.rend(); ++r_it)
+                std::cout << " " << r_it->first << " " << r_it->second;
+            std::cout << '\n';
+        }
+    }
+    std::cout.flush();
 }
 
 } //pacman_task
 
 
-#if 0
 namespace npuzzle_task {
-using puzzle_state_t = std::vector<std::vector<size_t>>;
+// Board as read from the input, row by row
+using puzzle_grid_t = std::vector<std::vector<size_t>>;
+
+// Moves of the blank in the order required by the Hackerrank task
+static const std::pair<int, int> puzzle_shifts[] = {
+    {-1,  0}, // UP
+    { 0, -1}, // LEFT
+    { 0,  1}, // RIGHT
+    { 1,  0}  // DOWN
+};
+static const char* const puzzle_shift_names[] = {"UP", "LEFT", "RIGHT", "DOWN"};
+
+// Largest k whose k*k cells of `bits` bits fit into the word and whose tiles fit into a cell
+constexpr std::size_t packed_board_max_k ( std::size_t word_bits, std::size_t bits ) {
+    std::size_t k = 0;
+    while ((k + 1) * (k + 1) * bits <= word_bits && (k + 1) * (k + 1) <= (std::size_t(1) << bits))
+        ++k;
+    return k;
+}
+
+// Board packed into one integer, `bits` bits per cell in row-major order.
+// The blank cell is cached, so a move is a few shifts and masks and copies are cheap.
+template <typename TWord, std::size_t bits>
+class PackedBoard {
+public:
+    static constexpr std::size_t max_k = packed_board_max_k(8 * sizeof(TWord), bits);
+
+private:
+    static constexpr TWord mask_ = (TWord(1) << bits) - 1;
+
+    TWord tiles_{0};
+    std::uint8_t k_{0};
+    std::uint8_t blank_{0};
+
+public:
+    PackedBoard () = default;
+
+    explicit PackedBoard ( puzzle_grid_t const& grid ) : k_(grid.size()) {
+        if (grid.size() > max_k)
+            throw std::invalid_argument("PackedBoard: board is too large");
+        for (std::size_t cell = 0; cell < k_ * k_; ++cell) {
+            TWord tile = grid[cell / k_][cell % k_];
+            tiles_ |= tile << (cell * bits);
+            if (tile == 0)
+                blank_ = cell;
+        }
+    }
+
+    std::size_t k () const { return k_; }
+    std::size_t blank () const { return blank_; }
+    std::size_t tile ( std::size_t cell ) const { return std::size_t((tiles_ >> (cell * bits)) & mask_); }
+    TWord word () const { return tiles_; }
+
+    bool can_move ( std::size_t d ) const {
+        // unsigned wrap-around sends moves over the top or left border out of range too
+        std::size_t i = blank_ / k_ + puzzle_shifts[d].first, j = blank_ % k_ + puzzle_shifts[d].second;
+        return i < k_ && j < k_;
+    }
+
+    // Slides the tile next to the blank in direction d into it, the move must be possible
+    void move ( std::size_t d ) {
+        std::size_t cell = blank_ + puzzle_shifts[d].first * int(k_) + puzzle_shifts[d].second;
+        TWord tile = (tiles_ >> (cell * bits)) & mask_;
+        tiles_ = (tiles_ & ~(mask_ << (cell * bits))) | (tile << (blank_ * bits));
+        blank_ = cell;
+    }
+
+    PackedBoard moved ( std::size_t d ) const {
+        PackedBoard board(*this);
+        board.move(d);
+        return board;
+    }
+
+    friend bool operator== ( PackedBoard const& l, PackedBoard const& r ) { return l.tiles_ == r.tiles_ && l.k_ == r.k_; }
+    friend bool operator!= ( PackedBoard const& l, PackedBoard const& r ) { return !(l == r); }
+    friend bool operator< ( PackedBoard const& l, PackedBoard const& r ) {
+        return l.k_ < r.k_ || (l.k_ == r.k_ && l.tiles_ < r.tiles_);
+    }
+};
+
+// 4 bits per tile, boards up to 4x4
+using puzzle_state_t = PackedBoard<std::uint64_t, 4>;
+// 5 bits per tile, boards up to 5x5
+using puzzle_wide_state_t = PackedBoard<unsigned __int128, 5>;
+} // namespace npuzzle_task
+
+namespace a_star_search {
+template <typename TWord, std::size_t bits>
+struct StateHash<npuzzle_task::PackedBoard<TWord, bits>> {
+    static std::size_t fold ( std::uint64_t word ) { return word; }
+    static std::size_t fold ( unsigned __int128 word ) { return std::uint64_t(word) ^ std::uint64_t(word >> 64) * 0x9e3779b97f4a7c15ull; }
+
+    std::size_t operator() ( npuzzle_task::PackedBoard<TWord, bits> const& state ) const { return fold(state.word()); }
+};
+} // namespace a_star_search
+
+namespace npuzzle_task {
 using puzzle_node_t = a_star_search::NodePtr<puzzle_state_t>;
 
 // TODO: make an abstract template
-class PuzzleNeighborFunctor {
-    std::pair<size_t, size_t> __findZero ( puzzle_state_t const& state ) {
-        size_t c_i{0}, c_j{0};
-        size_t k = state.size();
-        for (c_i = 0; c_i < k; ++c_i) {
-            for (c_j = 0; c_j < k; ++c_j) {
-                if ( state[c_i][c_j] == 0 )
-                    return {c_i, c_j};
+struct PuzzleNeighborFunctor {
+    template <typename TBoard, typename TOutputIterator>
+    void operator() ( TBoard const& current_state, TOutputIterator result  ) {
+        for (std::size_t d = 0; d < 4; ++d)
+            if (current_state.can_move(d))
+                *result++ = current_state.moved(d);
+    }
+};
+
+// Every generated board is a valid one
+struct PuzzleStateFilter {
+    template <typename TBoard>
+    bool operator() ( TBoard const& ) { return true; }
+};
+
+// Full evaluation kernels for 64-bit boards. The AVX2 versions unpack the nibbles into
+// one byte per cell and read goal rows and columns with byte shuffles; they are picked
+// at run time when the CPU has AVX2, the scalar loops are used everywhere else.
+struct PuzzleSimdTables {
+    std::uint8_t goal_row_[16], goal_col_[16], cell_row_[16], cell_col_[16];
+    // cells of the pairs (a, b), a before b, of every line: lines 0 and 1 in the low
+    // 16 bytes, lines 2 and 3 in the high ones, 6 pairs per line
+    std::uint8_t row_a_[32], row_b_[32], col_a_[32], col_b_[32];
+    // tiles to remove from a line of 4 given its 6-bit mask of pairs in conflict
+    std::uint8_t removals_[64];
+
+    explicit PuzzleSimdTables ( std::size_t k ) {
+        for (std::size_t i = 0; i < 16; ++i) {
+            goal_row_[i] = i / k;
+            goal_col_[i] = i % k;
+            cell_row_[i] = i < k * k ? i / k : 0xFF;
+            cell_col_[i] = i < k * k ? i % k : 0xFF;
+        }
+
+        static const int pairs[6][2] = {{0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3}};
+        std::fill(row_a_, row_a_ + 32, 15);
+        std::fill(row_b_, row_b_ + 32, 15);
+        std::fill(col_a_, col_a_ + 32, 15);
+        std::fill(col_b_, col_b_ + 32, 15);
+        for (std::size_t line = 0; line < k; ++line)
+            for (std::size_t p = 0; p < 6; ++p) {
+                std::size_t a = pairs[p][0], b = pairs[p][1];
+                if (b >= k)
+                    continue;
+                // cell 15 is always empty on boards smaller than 4x4
+                std::size_t byte = (line / 2) * 16 + (line % 2) * 6 + p;
+                row_a_[byte] = line * k + a;
+                row_b_[byte] = line * k + b;
+                col_a_[byte] = a * k + line;
+                col_b_[byte] = b * k + line;
+            }
+
+        // the smallest vertex cover of the conflict graph leaves the longest conflict-free run
+        for (int mask = 0; mask < 64; ++mask) {
+            removals_[mask] = 4;
+            for (int removed = 0; removed < 16; ++removed) {
+                bool covered = true;
+                for (int p = 0; p < 6; ++p)
+                    if ((mask >> p & 1) && !(removed >> pairs[p][0] & 1) && !(removed >> pairs[p][1] & 1))
+                        covered = false;
+                if (covered)
+                    removals_[mask] = std::min<int>(removals_[mask], __builtin_popcount(removed));
             }
         }
-        return {0, 0};
     }
 
+    static PuzzleSimdTables const& get ( std::size_t k ) {
+        static const PuzzleSimdTables tables[] = {PuzzleSimdTables(1), PuzzleSimdTables(1), PuzzleSimdTables(2),
+                                                  PuzzleSimdTables(3), PuzzleSimdTables(4)};
+        return tables[k];
+    }
+};
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define NPUZZLE_HAS_AVX2_KERNELS 1
+
+__attribute__((target("avx2")))
+inline __m128i puzzle_load ( std::uint8_t const* p ) { return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p)); }
+
+__attribute__((target("avx2")))
+inline __m128i puzzle_unpack_tiles ( std::uint64_t tiles ) {
+    __m128i packed = _mm_cvtsi64_si128(tiles);
+    __m128i nibble = _mm_set1_epi8(0x0F);
+    __m128i low = _mm_and_si128(packed, nibble);
+    __m128i high = _mm_and_si128(_mm_srli_epi16(packed, 4), nibble);
+    return _mm_unpacklo_epi8(low, high);
+}
+
+__attribute__((target("avx2")))
+inline int puzzle_manhattan_avx2 ( std::uint64_t tiles, std::size_t k ) {
+    auto const& tables = PuzzleSimdTables::get(k);
+
+    __m128i tile = puzzle_unpack_tiles(tiles);
+    __m128i row = _mm_shuffle_epi8(puzzle_load(tables.goal_row_), tile);
+    __m128i col = _mm_shuffle_epi8(puzzle_load(tables.goal_col_), tile);
+    __m128i distance = _mm_add_epi8(_mm_abs_epi8(_mm_sub_epi8(row, puzzle_load(tables.cell_row_))),
+                                    _mm_abs_epi8(_mm_sub_epi8(col, puzzle_load(tables.cell_col_))));
+    // the blank and the cells past k*k hold tile 0
+    distance = _mm_andnot_si128(_mm_cmpeq_epi8(tile, _mm_setzero_si128()), distance);
+
+    __m128i sums = _mm_sad_epu8(distance, _mm_setzero_si128());
+    return _mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4);
+}
+
+// Tiles to remove from the lines given by the pair tables, tiles out of their
+// goal line get keys that never compare as a conflict
+__attribute__((target("avx2")))
+inline int puzzle_line_conflicts_avx2 ( PuzzleSimdTables const& tables, __m128i in_line, __m128i goal,
+                                        std::uint8_t const* a, std::uint8_t const* b ) {
+    __m256i key_a = _mm256_broadcastsi128_si256(_mm_blendv_epi8(_mm_set1_epi8(-1), goal, in_line));
+    __m256i key_b = _mm256_broadcastsi128_si256(_mm_blendv_epi8(_mm_set1_epi8(100), goal, in_line));
+    __m256i pairs = _mm256_cmpgt_epi8(_mm256_shuffle_epi8(key_a, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a))),
+                                      _mm256_shuffle_epi8(key_b, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b))));
+    std::uint32_t mask = _mm256_movemask_epi8(pairs);
+    return tables.removals_[mask & 63] + tables.removals_[(mask >> 6) & 63]
+         + tables.removals_[(mask >> 16) & 63] + tables.removals_[(mask >> 22) & 63];
+}
+
+__attribute__((target("avx2")))
+inline int puzzle_linear_conflicts_avx2 ( std::uint64_t tiles, std::size_t k ) {
+    auto const& tables = PuzzleSimdTables::get(k);
+
+    __m128i tile = puzzle_unpack_tiles(tiles);
+    __m128i row = _mm_shuffle_epi8(puzzle_load(tables.goal_row_), tile);
+    __m128i col = _mm_shuffle_epi8(puzzle_load(tables.goal_col_), tile);
+    __m128i nonzero = _mm_xor_si128(_mm_cmpeq_epi8(tile, _mm_setzero_si128()), _mm_set1_epi8(-1));
+    __m128i in_row = _mm_and_si128(nonzero, _mm_cmpeq_epi8(row, puzzle_load(tables.cell_row_)));
+    __m128i in_col = _mm_and_si128(nonzero, _mm_cmpeq_epi8(col, puzzle_load(tables.cell_col_)));
+
+    return puzzle_line_conflicts_avx2(tables, in_row, col, tables.row_a_, tables.row_b_)
+         + puzzle_line_conflicts_avx2(tables, in_col, row, tables.col_a_, tables.col_b_);
+}
+
+inline bool puzzle_has_avx2 () {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+#endif
+
+inline int puzzle_tile_distance ( int tile, int cell, int k ) {
+    return std::abs(tile / k - cell / k) + std::abs(tile % k - cell % k);
+}
+
+// Sum of Manhattan distances of the tiles to their goal cells
+struct PuzzleHeuristic {
+    template <typename TBoard>
+    static int scalar ( TBoard const& state ) {
+        int k = state.k();
+        int manhattan = 0;
+        for (int cell = 0; cell < k * k; ++cell) {
+            int tile = state.tile(cell);
+            if (tile != 0)
+                manhattan += puzzle_tile_distance(tile, cell, k);
+        }
+        return manhattan;
+    }
+
+    template <typename TBoard>
+    int operator() ( TBoard const& state ) { return scalar(state); }
+
+    int operator() ( puzzle_state_t const& state ) {
+#ifdef NPUZZLE_HAS_AVX2_KERNELS
+        if (puzzle_has_avx2())
+            return puzzle_manhattan_avx2(state.word(), state.k());
+#endif
+        return scalar(state);
+    }
+
+    // One move changes the distance of the tile that took the old blank cell only
+    template <typename TBoard>
+    int operator() ( TBoard const& parent, int parent_h, TBoard const& state ) {
+        int k = state.k();
+        int tile = state.tile(parent.blank());
+        return parent_h - puzzle_tile_distance(tile, state.blank(), k) + puzzle_tile_distance(tile, parent.blank(), k);
+    }
+};
+
+// Manhattan distance plus two moves for every tile that has to leave its goal row or column
+// to let the others pass (Hansson, Mayer and Yung, 1992). In a line the tiles that can stay
+// form the longest run with increasing goal positions.
+struct PuzzleLinearConflictHeuristic {
+    // Tiles to remove from row (vertical = false) or column `line` of the board
+    template <typename TBoard>
+    static int line_conflicts ( TBoard const& state, int line, bool vertical ) {
+        int k = state.k();
+        int goals[puzzle_wide_state_t::max_k];
+        int n = 0;
+        for (int i = 0; i < k; ++i) {
+            int tile = state.tile(vertical ? i * k + line : line * k + i);
+            if (tile != 0 && (vertical ? tile % k : tile / k) == line)
+                goals[n++] = vertical ? tile / k : tile % k;
+        }
+
+        int longest[puzzle_wide_state_t::max_k];
+        int keep = 0;
+        for (int i = 0; i < n; ++i) {
+            longest[i] = 1;
+            for (int j = 0; j < i; ++j)
+                if (goals[j] < goals[i])
+                    longest[i] = std::max(longest[i], longest[j] + 1);
+            keep = std::max(keep, longest[i]);
+        }
+        return n - keep;
+    }
+
+    // Tiles to remove from all rows and columns
+    template <typename TBoard>
+    static int scalar_conflicts ( TBoard const& state ) {
+        int k = state.k();
+        int conflicts = 0;
+        for (int line = 0; line < k; ++line)
+            conflicts += line_conflicts(state, line, false) + line_conflicts(state, line, true);
+        return conflicts;
+    }
+
+    template <typename TBoard>
+    static int conflicts ( TBoard const& state ) { return scalar_conflicts(state); }
+
+    static int conflicts ( puzzle_state_t const& state ) {
+#ifdef NPUZZLE_HAS_AVX2_KERNELS
+        if (puzzle_has_avx2())
+            return puzzle_linear_conflicts_avx2(state.word(), state.k());
+#endif
+        return scalar_conflicts(state);
+    }
+
+    template <typename TBoard>
+    int operator() ( TBoard const& state ) { return PuzzleHeuristic{}(state) + 2 * conflicts(state); }
+
+    // A horizontal move changes two columns, a vertical one two rows
+    template <typename TBoard>
+    int operator() ( TBoard const& parent, int parent_h, TBoard const& state ) {
+        int k = state.k();
+        int from = state.blank(), to = parent.blank();
+        bool vertical = from / k == to / k;
+        int from_line = vertical ? from % k : from / k, to_line = vertical ? to % k : to / k;
+
+        int conflicts = line_conflicts(state, from_line, vertical) + line_conflicts(state, to_line, vertical)
+                      - line_conflicts(parent, from_line, vertical) - line_conflicts(parent, to_line, vertical);
+        return PuzzleHeuristic{}(parent, parent_h, state) + 2 * conflicts;
+    }
+};
+
+// Disjoint additive pattern database: the tiles are split into groups and for every
+// placement of a group the table keeps the number of moves of the group tiles needed
+// to bring them home. Moves of other tiles are free, so the sum over the groups is admissible.
+// Tables are built offline (tools/npuzzle_pdb_build) and memory-mapped by the solver.
+class PuzzlePatternDatabase {
 public:
-    template <typename TOutputIterator>
-    void operator() ( puzzle_state_t const& current_state, TOutputIterator result  ) {
+    static constexpr std::size_t max_k = 5;
+    static constexpr std::size_t max_pattern_size = 8;
+
+private:
+    static constexpr char file_magic_[8] = {'N', 'P', 'Z', 'P', 'D', 'B', '1', '\0'};
+    static constexpr std::uint8_t unknown_ = std::numeric_limits<std::uint8_t>::max();
+
+    struct FileHeader {
+        char magic_[8];
+        std::uint32_t k_;
+        std::uint32_t patterns_;
+    };
+    struct FilePattern {
+        std::uint32_t size_;
+        std::uint8_t tiles_[max_pattern_size];
+    };
+
+    std::size_t k_{0};
+    std::vector<std::vector<std::uint8_t>> patterns_;
+    std::vector<std::uint8_t const*> tables_;
+    // tables are either built in memory or mapped from a file
+    std::vector<std::vector<std::uint8_t>> storage_;
+    void* mapping_{nullptr};
+    std::size_t mapping_size_{0};
+
+    // Number of placements of m tiles on n cells
+    static std::size_t table_size ( std::size_t n, std::size_t m ) {
+        std::size_t size = 1;
+        for (std::size_t i = 0; i < m; ++i)
+            size *= n - i;
+        return size;
+    }
 
-        auto zero_pos = __findZero(current_state);
+    // Index of the placement among all placements of m tiles on n cells
+    static std::size_t rank ( std::uint8_t const* positions, std::size_t m, std::size_t n ) {
+        std::size_t r = 0;
+        std::uint32_t used = 0;
+        for (std::size_t i = 0; i < m; ++i) {
+            std::uint32_t bit = std::uint32_t(1) << positions[i];
+            r = r * (n - i) + positions[i] - __builtin_popcount(used & (bit - 1));
+            used |= bit;
+        }
+        return r;
+    }
 
-        std::vector< std::pair<int, int> > shifts {
-            {-1,  0}, // UP
-            { 0, -1}, // LEFT
-            { 0,  1}, // RIGHT
-            { 1,  0}  // DOWN
+    // 0-1 BFS backwards from the goal over placements of the pattern together with the blank.
+    // The blank is needed to know which moves are possible, the table keeps the cheapest blank cell.
+    static std::vector<std::uint8_t> build_table ( std::size_t k, std::vector<std::uint8_t> const& tiles ) {
+        std::size_t n = k * k, m = tiles.size();
+        std::vector<std::uint8_t> table(table_size(n, m), unknown_);
+        std::vector<std::uint64_t> closed((table.size() * n + 63) / 64);
+
+        // queue entries hold the blank and the tile cells, 5 bits each
+        auto pack = [m](std::uint8_t const* positions, std::uint8_t blank) {
+            std::uint64_t e = blank;
+            for (std::size_t i = 0; i < m; ++i)
+                e |= std::uint64_t(positions[i]) << (5 * (i + 1));
+            return e;
         };
 
-        for (auto sh const& : shifts) 
+        std::uint8_t positions[max_pattern_size];
+        std::copy(tiles.begin(), tiles.end(), positions);
+        std::vector<std::uint64_t> current{pack(positions, 0)}, next;
+
+        for (std::uint8_t d = 0; !current.empty(); ++d) {
+            while (!current.empty()) {
+                std::uint64_t e = current.back();
+                current.pop_back();
+
+                std::uint8_t blank = e & 31;
+                for (std::size_t i = 0; i < m; ++i)
+                    positions[i] = (e >> (5 * (i + 1))) & 31;
+
+                std::size_t r = rank(positions, m, n);
+                std::size_t index = r * n + blank;
+                if (closed[index / 64] & (std::uint64_t(1) << (index % 64)))
+                    continue;
+                closed[index / 64] |= std::uint64_t(1) << (index % 64);
+                if (table[r] == unknown_)
+                    table[r] = d;
+
+                for (auto const& sh : puzzle_shifts) {
+                    std::size_t i = blank / k + sh.first, j = blank % k + sh.second;
+                    if (i >= k || j >= k)
+                        continue;
+                    std::uint8_t cell = i * k + j;
+
+                    std::size_t t = std::find(positions, positions + m, cell) - positions;
+                    if (t < m) {
+                        // a pattern tile moves into the blank, costs one move
+                        positions[t] = blank;
+                        next.push_back(pack(positions, cell));
+                        positions[t] = cell;
+                    } else {
+                        std::size_t moved = r * n + cell;
+                        if (!(closed[moved / 64] & (std::uint64_t(1) << (moved % 64))))
+                            current.push_back(pack(positions, cell));
+                    }
+                }
+            }
+            std::swap(current, next);
+        }
+        return table;
+    }
+
+    void unmap () {
+        if (mapping_)
+            munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+    }
+
+public:
+    PuzzlePatternDatabase () = default;
+    PuzzlePatternDatabase ( PuzzlePatternDatabase const& ) = delete;
+    PuzzlePatternDatabase& operator= ( PuzzlePatternDatabase const& ) = delete;
+    PuzzlePatternDatabase ( PuzzlePatternDatabase&& other ) { *this = std::move(other); }
+    PuzzlePatternDatabase& operator= ( PuzzlePatternDatabase&& other ) {
+        unmap();
+        k_ = other.k_;
+        patterns_ = std::move(other.patterns_);
+        tables_ = std::move(other.tables_);
+        storage_ = std::move(other.storage_);
+        mapping_ = other.mapping_;
+        mapping_size_ = other.mapping_size_;
+        other.mapping_ = nullptr;
+        return *this;
+    }
+    ~PuzzlePatternDatabase () { unmap(); }
+
+    // Tiles 1..k*k-1 cut in row-major groups: 4-4 for 3x3, 6-6-3 for 4x4, 5-5-5-5-4 for 5x5
+    static std::vector<std::vector<std::uint8_t>> default_patterns ( std::size_t k ) {
+        std::size_t group = k == 3 ? 4 : k == 4 ? 6 : 5;
+        std::vector<std::vector<std::uint8_t>> patterns;
+        for (std::size_t tile = 1; tile < k * k; ++tile) {
+            if ((tile - 1) % group == 0)
+                patterns.emplace_back();
+            patterns.back().push_back(tile);
+        }
+        return patterns;
+    }
+
+    // Builds the tables with one BFS per pattern, spread over `threads` threads
+    PuzzlePatternDatabase ( std::size_t k, std::vector<std::vector<std::uint8_t>> const& patterns,
+                            unsigned threads = std::max(1u, std::thread::hardware_concurrency()) ) : k_(k)
+                                                                                                   , patterns_(patterns)
+                                                                                                   , storage_(patterns.size()) {
+        if (k < 2 || k > max_k)
+            throw std::invalid_argument("PuzzlePatternDatabase: unsupported board size");
+        for (auto const& p : patterns_)
+            if (p.empty() || p.size() > max_pattern_size)
+                throw std::invalid_argument("PuzzlePatternDatabase: unsupported pattern size");
+
+        threads = std::max(1u, threads);
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < std::min<std::size_t>(threads, patterns_.size()); ++t)
+            workers.emplace_back([&, t]() {
+                for (std::size_t p = t; p < patterns_.size(); p += threads)
+                    storage_[p] = build_table(k_, patterns_[p]);
+            });
+        for (auto& w : workers)
+            w.join();
+
+        for (auto const& table : storage_)
+            tables_.push_back(table.data());
+    }
+
+    bool empty () const { return tables_.empty(); }
+    std::size_t k () const { return k_; }
+
+    // Sum of the pattern costs of the board, it must have the database size
+    template <typename TBoard>
+    int operator() ( TBoard const& state ) const {
+        std::size_t n = k_ * k_;
+        std::uint8_t cell_of[max_k * max_k];
+        for (std::size_t i = 0; i < n; ++i)
+            cell_of[state.tile(i)] = i;
+
+        int h = 0;
+        std::uint8_t positions[max_pattern_size];
+        for (std::size_t p = 0; p < patterns_.size(); ++p) {
+            for (std::size_t i = 0; i < patterns_[p].size(); ++i)
+                positions[i] = cell_of[patterns_[p][i]];
+            h += tables_[p][rank(positions, patterns_[p].size(), n)];
+        }
+        return h;
+    }
+
+    // Layout: magic, k and pattern count, the patterns, then the tables one byte per placement
+    void save ( std::string const& file_name ) const {
+        std::ofstream out(file_name, std::ios::binary);
+        FileHeader header{{}, std::uint32_t(k_), std::uint32_t(patterns_.size())};
+        std::copy(file_magic_, file_magic_ + sizeof(file_magic_), header.magic_);
+        out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+        for (auto const& p : patterns_) {
+            FilePattern pattern{std::uint32_t(p.size()), {}};
+            std::copy(p.begin(), p.end(), pattern.tiles_);
+            out.write(reinterpret_cast<char const*>(&pattern), sizeof(pattern));
+        }
+        for (std::size_t p = 0; p < patterns_.size(); ++p)
+            out.write(reinterpret_cast<char const*>(tables_[p]), table_size(k_ * k_, patterns_[p].size()));
+        if (!out)
+            throw std::runtime_error("PuzzlePatternDatabase: cannot write " + file_name);
+    }
+
+    // Maps the file read-only, the tables are paged in on first use
+    static PuzzlePatternDatabase load ( std::string const& file_name ) {
+        int fd = open(file_name.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("PuzzlePatternDatabase: cannot open " + file_name);
+        struct stat st;
+        bool has_size = fstat(fd, &st) == 0;
+
+        PuzzlePatternDatabase database;
+        if (has_size && std::size_t(st.st_size) >= sizeof(FileHeader)) {
+            database.mapping_size_ = st.st_size;
+            database.mapping_ = mmap(nullptr, database.mapping_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (database.mapping_ == MAP_FAILED)
+                database.mapping_ = nullptr;
+        }
+        close(fd);
+        if (!database.mapping_)
+            throw std::runtime_error("PuzzlePatternDatabase: cannot map " + file_name);
+
+        auto data = static_cast<std::uint8_t const*>(database.mapping_);
+        auto const& header = *reinterpret_cast<FileHeader const*>(data);
+        std::size_t offset = sizeof(FileHeader) + header.patterns_ * sizeof(FilePattern);
+        if (!std::equal(file_magic_, file_magic_ + sizeof(file_magic_), header.magic_)
+                || header.k_ < 2 || header.k_ > max_k || offset > database.mapping_size_)
+            throw std::runtime_error("PuzzlePatternDatabase: " + file_name + " is not a pattern database");
+
+        database.k_ = header.k_;
+        auto patterns = reinterpret_cast<FilePattern const*>(data + sizeof(FileHeader));
+        for (std::size_t p = 0; p < header.patterns_; ++p) {
+            if (patterns[p].size_ == 0 || patterns[p].size_ > max_pattern_size)
+                throw std::runtime_error("PuzzlePatternDatabase: " + file_name + " is not a pattern database");
+            database.patterns_.emplace_back(patterns[p].tiles_, patterns[p].tiles_ + patterns[p].size_);
+            database.tables_.push_back(data + offset);
+            offset += table_size(database.k_ * database.k_, patterns[p].size_);
+        }
+        if (offset > database.mapping_size_)
+            throw std::runtime_error("PuzzlePatternDatabase: " + file_name + " is truncated");
+        return database;
+    }
+};
+
+constexpr std::uint8_t PuzzlePatternDatabase::unknown_;
+constexpr char PuzzlePatternDatabase::file_magic_[8];
+
+// Pattern database heuristic, falls back to Manhattan distance with linear conflicts
+// when there is no database for the board size
+struct PuzzlePatternHeuristic {
+    PuzzlePatternDatabase const* database_;
+
+    template <typename TBoard>
+    bool has_database ( TBoard const& state ) const { return database_ && !database_->empty() && database_->k() == state.k(); }
+
+    template <typename TBoard>
+    int operator() ( TBoard const& state ) {
+        if (has_database(state))
+            return (*database_)(state);
+        return PuzzleLinearConflictHeuristic{}(state);
     }
+
+    template <typename TBoard>
+    int operator() ( TBoard const& parent, int parent_h, TBoard const& state ) {
+        if (has_database(state))
+            return (*database_)(state);
+        return PuzzleLinearConflictHeuristic{}(parent, parent_h, state);
+    }
+};
+
+// Moves of the blank for IDA*, given as indices into puzzle_shifts
+struct PuzzleMoves {
+    using move_type = std::size_t;
+
+    template <typename TBoard, typename TOutputIterator>
+    void moves ( TBoard const& state, TOutputIterator result ) const {
+        for (move_type d = 0; d < 4; ++d)
+            if (state.can_move(d))
+                *result++ = d;
+    }
+
+    template <typename TBoard>
+    void apply ( TBoard& state, move_type d ) const { state.move(d); }
+
+    // UP and DOWN, LEFT and RIGHT are opposite
+    template <typename TBoard>
+    void undo ( TBoard& state, move_type d ) const { state.move(3 - d); }
+    bool is_inverse ( move_type last, move_type d ) const { return last == 3 - d; }
 };
 
-void npuzzle_solve ( puzzle_state_t const& start,  puzzle_state_t const& goal) {
-    std::vector<puzzle_state_t> result_path; 
-    std::vector<puzzle_state_t> explored_nodes;
+struct PuzzleComparator {
+    bool operator() ( puzzle_node_t const l, puzzle_node_t const r ) { return l->get_total_score() > r->get_total_score(); }
+};
+
+template <typename TVisitedSet = a_star_search::DefaultVisitedSet<puzzle_state_t>,
+          typename TResultPathIterator,
+          typename TExploredNodeIterator>
+void npuzzle_search ( puzzle_state_t const& start, puzzle_state_t const& goal,
+        TResultPathIterator result_path_it, TExploredNodeIterator explored_node_it ) {
+
+    a_star_search::NodeVisitor<puzzle_state_t,
+        PuzzleNeighborFunctor, PuzzleStateFilter,
+        std::priority_queue<puzzle_node_t, std::vector<puzzle_node_t>, PuzzleComparator>,
+        PuzzleHeuristic, TVisitedSet> puzzle_node_visitor(PuzzleStateFilter{}, PuzzleHeuristic{});
+
+    a_star_search::a_star<puzzle_state_t> (
+            start, goal,
+            puzzle_node_visitor,
+            result_path_it,
+            explored_node_it
+          );
+}
+
+// Hash-distributed A* on `threads` threads, writes the boards from goal to start
+template <typename TBoard,
+          typename FHeuristic = PuzzleLinearConflictHeuristic,
+          typename TResultPathIterator>
+bool npuzzle_hda_star_search ( TBoard const& start, TBoard const& goal, unsigned threads,
+        TResultPathIterator result_path_it, a_star_search::HdaStarStats* stats = nullptr, FHeuristic heuristic = {} ) {
+    return a_star_search::hda_star(start, goal, PuzzleNeighborFunctor{}, PuzzleStateFilter{}, heuristic,
+                                   threads, result_path_it, stats);
+}
+
+// Pattern database for the board size, made by tools/npuzzle_pdb_build
+std::string npuzzle_pdb_file ( std::size_t k ) { return "npuzzle_pdb_" + std::to_string(k) + ".bin"; }
+
+// IDA* keeps only the current path, so large boards do not run out of memory.
+// Uses the pattern database from the working directory when there is one.
+template <typename TBoard>
+void npuzzle_board_solve ( TBoard const& start, TBoard const& goal ) {
+    std::vector<PuzzleMoves::move_type> result_moves;
+    std::size_t explored_nodes = 0;
+
+    PuzzlePatternDatabase database;
+    try {
+        database = PuzzlePatternDatabase::load(npuzzle_pdb_file(start.k()));
+    } catch (std::runtime_error const&) {
+    }
+
+    PuzzleMoves moves;
+    PuzzlePatternHeuristic heuristic{&database};
+    a_star_search::ida_star(start, goal, moves, heuristic,
+                            std::back_inserter(result_moves), a_star_search::CountingIterator{&explored_nodes});
+
+    // print number of moves and the moves of the blank
+    std::cout << result_moves.size() << std::endl;
+    for (auto d : result_moves)
+        std::cout << puzzle_shift_names[d] << std::endl;
+}
 
+// Parity that no move changes: inversions among the tiles, plus the row of the blank when
+// the width is even, where a vertical move shifts a tile past k - 1 others
+int npuzzle_parity ( puzzle_grid_t const& grid ) {
+    std::vector<std::size_t> tiles;
+    std::size_t blank_row = 0;
+    for (std::size_t i = 0; i < grid.size(); ++i)
+        for (std::size_t tile : grid[i]) {
+            if (tile == 0)
+                blank_row = i;
+            else
+                tiles.push_back(tile);
+        }
+
+    std::size_t inversions = 0;
+    for (std::size_t i = 0; i < tiles.size(); ++i)
+        for (std::size_t j = i + 1; j < tiles.size(); ++j)
+            inversions += tiles[i] > tiles[j];
+    return int((inversions + (grid.size() % 2 == 0 ? blank_row : 0)) % 2);
+}
+
+// Half of the boards cannot reach the goal, IDA* would deepen forever on them
+bool npuzzle_solvable ( puzzle_grid_t const& start, puzzle_grid_t const& goal ) {
+    return npuzzle_parity(start) == npuzzle_parity(goal);
+}
 
+// 64-bit boards up to 4x4, 128-bit ones for 5x5, -1 when there is no solution
+void npuzzle_solve ( puzzle_grid_t const& start, puzzle_grid_t const& goal ) {
+    if (!npuzzle_solvable(start, goal))
+        std::cout << -1 << std::endl;
+    else if (start.size() <= puzzle_state_t::max_k)
+        npuzzle_board_solve(puzzle_state_t(start), puzzle_state_t(goal));
+    else
+        npuzzle_board_solve(puzzle_wide_state_t(start), puzzle_wide_state_t(goal));
 }
 
 template <typename TSolveFunction>
@@ -381,7 +3831,7 @@ void read_data( TSolveFunction const& solve_function ) {
     int k;
     std::cin >> k;
    
-    puzzle_state_t start (k);
+    puzzle_grid_t start (k);
 
     for (int i = 0; i< k; ++i) {
         start[i].resize(k);
@@ -389,7 +3839,7 @@ void read_data( TSolveFunction const& solve_function ) {
             std::cin >> start[i][j];
     }
 
-    puzzle_state_t goal(k);
+    puzzle_grid_t goal(k);
     auto n = 0;
     for ( auto& v: goal ) {
         v.resize(k);
@@ -400,17 +3850,29 @@ void read_data( TSolveFunction const& solve_function ) {
 }
 
 } // namespace npuzzle_task
-#endif
 
 
-int main(void) {
+#ifndef PACMAN_NO_MAIN
+int main(int argc, char** argv) {
+    // pacman --batch [threads]: one grid, many queries
+    if (argc > 1 && std::string(argv[1]) == "--batch") {
+        if (argc > 2)
+            pacman_task::read_batch(std::max(1, std::atoi(argv[2])));
+        else
+            pacman_task::read_batch();
+        return 0;
+    }
 
     pacman_task::read_data<decltype(pacman_task::pacman_dfs_solve)> (pacman_task::pacman_dfs_solve);
 //    pacman_task::read_data<decltype(pacman_task::pacman_bfs_solve)> (pacman_task::pacman_bfs_solve);
 //    pacman_task::read_data<decltype(pacman_task::pacman_ucs_solve)> (pacman_task::pacman_ucs_solve);    
 //    pacman_task::read_data<decltype(pacman_task::pacman_astar_solve)> (pacman_task::pacman_astar_solve);
+//    pacman_task::read_data<decltype(pacman_task::pacman_jps_solve)> (pacman_task::pacman_jps_solve);
+//    pacman_task::read_data<decltype(pacman_task::pacman_parallel_bfs_solve)> (pacman_task::pacman_parallel_bfs_solve);
+//    pacman_task::read_data<decltype(pacman_task::pacman_distance_field_solve)> (pacman_task::pacman_distance_field_solve);
 //
-//    npuzzle_task::read_data<npuzzle_task::npuzzle_solve> (npuzzle_task::npuzzle_solve); 
+//    npuzzle_task::read_data<decltype(npuzzle_task::npuzzle_solve)> (npuzzle_task::npuzzle_solve);
 
     return 0;
 }
+#endif
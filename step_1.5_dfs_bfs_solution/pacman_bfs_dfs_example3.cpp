@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <set>
+#include <unordered_set>
 #include <stack>
 #include <queue>
 #include <memory>
@@ -31,6 +32,10 @@ using namespace a_star_helper;
 template<typename T>
 concept StateSpaceEl = std::totally_ordered<T> && NotSmartPointer<T> && !std::is_pointer_v<T>;
 
+// States std::hash covers, the visited set is a hash set for them
+template <typename T>
+concept Hashable = requires (T const& state) { {std::hash<T>{}(state)} -> std::convertible_to<std::size_t>; };
+
 template <typename Container>
 concept OrderableContainer =   requires (Container c, typename Container::value_type const& el) { c.push(el); c.pop();}
                            && (requires (Container c) { {c.front()} -> std::convertible_to <typename Container::value_type>; }
@@ -75,7 +80,7 @@ public:
 private:
     TContainer c_{};
     FGetNeighbors get_neighbors_;
-    std::set<TState, std::less<>> visited_;
+    std::conditional_t<Hashable<TState>, std::unordered_set<TState>, std::set<TState, std::less<>>> visited_;
 
     bool isVisited (TState const& state) { return visited_.find(state) != visited_.end(); }
 
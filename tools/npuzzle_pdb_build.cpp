@@ -0,0 +1,20 @@
+// Offline builder of the N-puzzle pattern database used by npuzzle_solve.
+// Usage: npuzzle_pdb_build [k] [output file], defaults to the 6-6-3 database of the 15-puzzle
+// written to npuzzle_pdb_4.bin. Patterns are built in parallel, one BFS per pattern.
+#define PACMAN_NO_MAIN
+#include "pacman.cpp"
+
+#include <chrono>
+
+int main(int argc, char** argv) {
+    std::size_t k = argc > 1 ? std::stoul(argv[1]) : 4;
+    std::string file_name = argc > 2 ? argv[2] : npuzzle_task::npuzzle_pdb_file(k);
+
+    auto start = std::chrono::steady_clock::now();
+    npuzzle_task::PuzzlePatternDatabase database(k, npuzzle_task::PuzzlePatternDatabase::default_patterns(k));
+    database.save(file_name);
+
+    std::cout << "wrote " << file_name << " in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s" << std::endl;
+    return 0;
+}